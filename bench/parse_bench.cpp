@@ -0,0 +1,93 @@
+// Parse benchmark for GitHub payloads.
+//
+//   make bench              # nlohmann SAX only
+//   make bench SIMDJSON=1   # nlohmann SAX vs simdjson on-demand
+//   ./run/parse-bench [payload.json ...]   (defaults to bench/payloads/*.json)
+
+#include "github_parser.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using Parser = std::function<size_t(const std::string&)>;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+// Runs the parser for at least half a second and prints throughput.
+static void run(const char* name, const std::string& payload, const Parser& parse) {
+    size_t commits = parse(payload);  // warm-up
+
+    size_t iterations = 0;
+    auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    while (elapsed < std::chrono::milliseconds(500)) {
+        parse(payload);
+        ++iterations;
+        elapsed = Clock::now() - start;
+    }
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double per_parse_us = seconds * 1e6 / iterations;
+    double mb_per_s = payload.size() * iterations / seconds / (1024.0 * 1024.0);
+    std::printf("  %-16s %10.1f us/parse %10.1f MB/s   (%zu commits)\n", name, per_parse_us, mb_per_s, commits);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        paths.emplace_back(argv[i]);
+    }
+    if (paths.empty()) {
+        paths = {"bench/payloads/commits.json", "bench/payloads/compare.json", "bench/payloads/push.json"};
+    }
+
+    for (const std::string& path : paths) {
+        std::string payload = read_file(path);
+        if (payload.empty()) {
+            std::fprintf(stderr, "cannot read %s\n", path.c_str());
+            return 1;
+        }
+        std::printf("%s (%zu bytes)\n", path.c_str(), payload.size());
+
+        run("nlohmann-dom", payload, [](const std::string& text) {
+            nlohmann::json doc = nlohmann::json::parse(text);
+            return doc.is_array() ? doc.size() : doc["commits"].size();
+        });
+        run("nlohmann-sax", payload, [](const std::string& text) {
+            std::pmr::monotonic_buffer_resource arena;
+            CommitList commits(&arena);
+            parse_commits_nlohmann(text, commits);
+            return commits.size();
+        });
+        run("stream-64k", payload, [](const std::string& text) {
+            size_t commits = 0;
+            PushStreamParser parser([&commits](const CommitRecord&) { ++commits; });
+            std::string_view input(text);
+            for (size_t offset = 0; offset < input.size(); offset += 64 * 1024) {
+                parser.feed(input.substr(offset, 64 * 1024));
+            }
+            parser.finish();
+            return commits;
+        });
+#ifdef BOTHUB_SIMDJSON
+        run("simdjson", payload, [](const std::string& text) {
+            std::pmr::monotonic_buffer_resource arena;
+            CommitList commits(&arena);
+            parse_commits_simdjson(text, commits);
+            return commits.size();
+        });
+#endif
+    }
+    return 0;
+}
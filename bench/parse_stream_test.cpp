@@ -0,0 +1,86 @@
+// Conformance checks for PushStreamParser, fed one byte at a time.
+//
+//   make parse-test
+
+#include "github_parser.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Feeds `payload` in 1-byte chunks; returns whether it was accepted and the shas seen
+static bool parse_bytewise(const std::string& payload, std::vector<std::string>& shas) {
+    PushStreamParser parser([&shas](const CommitRecord& commit) { shas.emplace_back(commit.sha); });
+    for (char c : payload) {
+        if (!parser.feed(std::string_view(&c, 1))) {
+            return false;
+        }
+    }
+    return parser.finish();
+}
+
+int main() {
+    const std::vector<std::string> malformed = {
+        R"({"commits":[{"id":"a" "message":"x"}]})",  // missing comma
+        R"({"commits":[{"id":"a",,"message":"x"}]})",
+        R"({"commits":[{"id":"a","message":"x",}]})",
+        R"({"commits":[{"id" "a"}]})",                // missing colon
+        R"({"commits":[{"id"::"a"}]})",
+        R"({"commits":[{"id":}]})",
+        R"({"commits":[1,]})",
+        R"({"commits":[,1]})",
+        R"({"commits" 1})",
+        R"({"x":tru})",
+        R"({"x":truex})",
+        R"({"x":nul})",
+        R"({"x":01})",
+        R"({"x":1.})",
+        R"({"x":-})",
+        R"({"x":1e})",
+        R"({"x":1-2})",
+        R"({"x":"a)" "\x01" R"(b"})",                 // raw control byte in a string
+        R"({"x":"a\qb"})",
+        R"({"x":"\u12G4"})",
+        R"({"x":1)",
+        R"({"x":1}})",
+        R"({"x":1} {"y":2})",
+        R"({"x":1}])",
+        R"([1} )",
+        R"({1:2})",
+        R"("unterminated)",
+        "",
+    };
+    const std::vector<std::string> valid = {
+        R"({"x":true,"y":false,"z":null,"n":[0,-1,2.5,1e3,-0.5E-2],"s":"a\né"})",
+        R"([])",
+        R"({})",
+        "  42  ",
+    };
+
+    int failures = 0;
+    for (const std::string& payload : malformed) {
+        std::vector<std::string> shas;
+        if (parse_bytewise(payload, shas)) {
+            std::printf("FAIL accepted malformed: %s\n", payload.c_str());
+            ++failures;
+        }
+    }
+    for (const std::string& payload : valid) {
+        std::vector<std::string> shas;
+        if (!parse_bytewise(payload, shas)) {
+            std::printf("FAIL rejected valid: %s\n", payload.c_str());
+            ++failures;
+        }
+    }
+
+    // Fields land where they belong
+    std::vector<std::string> shas;
+    const std::string push = R"({"ref":"refs/heads/main","commits":[{"id":"a1","message":"x"},{"id":"b2","message":"y"}],)"
+                             R"("repository":{"full_name":"o/r","default_branch":"main"}})";
+    if (!parse_bytewise(push, shas) || shas != std::vector<std::string>{"a1", "b2"}) {
+        std::printf("FAIL push payload commits\n");
+        ++failures;
+    }
+
+    std::printf("%s (%d failure(s))\n", failures ? "❌ parse-test failed" : "✅ parse-test passed", failures);
+    return failures ? 1 : 0;
+}
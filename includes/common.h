@@ -2,21 +2,19 @@
 #define COMMON_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <optional>
 #include <QObject>
 #include <QTimer>
 #include "logger.h"
 #include "helpers.h"
-
-// === Database Connection ===
-extern std::string DB_CONN;
-
-// === IRC Colors ===
-extern std::map<std::string, std::string> IRC_COLORS;
+#include "github_parser.h"
 
 // === Functions for Admin System ===
 bool is_admin(const std::string& hostmask);
+void invalidate_admin_cache();
 std::string add_admin(const std::string& sender_hostmask, const std::string& new_admin_hostmask);
 std::string remove_admin(const std::string& sender_hostmask, const std::string& target_hostmask);
 
@@ -24,21 +22,69 @@ std::string remove_admin(const std::string& sender_hostmask, const std::string&
 std::string add_repo(const std::string& sender_hostmask, const std::string& repo);
 std::string remove_repo(const std::string& sender_hostmask, const std::string& repo);
 std::string get_last_commit(const std::string& repo);
+void invalidate_tracked_repo_cache();
 
 // === Functions for GitHub Events ===
 void fetch_latest_commit(const std::string& repo);
-std::vector<std::string> get_tracked_repos();
+// False if the batch could not be stored (database down); the delivery should be retried
+bool handle_push_event(PushBatch& batch);
+// False if the commits could not be stored; the producer is told so it can resend them
+bool handle_local_commits(std::string_view repo, const CommitList& commits, std::pmr::memory_resource* arena);
+struct TrackedRepo {
+    std::string name;
+    std::string last_commit_sha;  // "" if none yet
+};
+std::vector<TrackedRepo> get_tracked_repos();
 
 // ✅ Declare function to start commit checking
 void start_commit_checker();
 void check_for_new_commits();
 
 // ✅ Declare function to send messages to IRC
-void send_irc_message(const std::string& message);
+void send_irc_message(std::string_view message);
 
 // === Database Functions ===
 void initialize_database();
-void store_commit_info(const std::string& repo, const std::string& sha, const std::string& author, const std::string& message, const std::string& url, int additions, int deletions, int changes);
-bool is_commit_stored(const std::string& repo, const std::string& sha);
+void run_migrations();
+void maintain_database();
+void start_database_maintenance();
+
+// ✅ A commit waiting to be written by store_commits(); the views must outlive the call
+struct PendingCommit {
+    std::string_view repo;
+    CommitRecord commit;
+};
+
+// ✅ New last_commit_sha for a tracked repo, written with the commits that produced it
+struct RepoCheckpoint {
+    std::string repo;
+    std::string sha;
+};
+
+void store_commits(const std::vector<PendingCommit>& commits, const std::vector<RepoCheckpoint>& checkpoints,
+                   std::vector<bool>& inserted);
+// ✅ Full-text search over stored commit messages, newest first, one page at a time
+struct SearchCursor {  // key of the last result shown
+    std::string committed_at;
+    int repo_id = 0;
+    std::string sha;
+};
+struct SearchQuery {
+    std::string terms;
+    std::string repo;                  // "" searches every repo
+    std::optional<SearchCursor> after;  // unset for the first page
+};
+struct SearchPage {
+    std::vector<std::string> lines;
+    std::optional<SearchCursor> next;  // set if there are more results
+};
+SearchPage search_commits(const SearchQuery& query, size_t page_size);
+// ✅ Commit statistics from the rollup tables, rendered for IRC; "" if the repo has no
+// stored commits. Both throw on database errors.
+std::string repo_commit_stats(const std::string& repo, int days);
+std::string top_committers(const std::string& repo, size_t limit);
+
+bool webhook_delivery_seen(const std::string& delivery_id);
+void record_webhook_delivery(const std::string& delivery_id);
 
 #endif
@@ -3,8 +3,37 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <vector>
 
-// Global configuration variables
+// ✅ Settings read off the IRC thread (database executors, poller, webhook workers).
+// load_config() publishes a new snapshot instead of changing one in place; a reader keeps
+// the one it got for as long as it holds the pointer.
+struct Config {
+    std::string github_api_key;
+    std::string db_conn;
+    int db_pool_size = 4;
+    int db_pool_timeout_ms = 5000;
+    std::vector<std::string> db_replica_conns;
+    int db_replica_max_lag_ms = 5000;
+    int commit_retention_months = 0;  // 0 keeps all history
+    int commit_partitions_ahead = 3;
+    bool webhook_enabled = false;
+    int webhook_verify_interval = 1800;  // seconds between polls of repos with live hooks
+    int webhook_liveness = 3600;         // seconds without deliveries before a hook counts as quiet
+    std::map<std::string, std::string> irc_colors;
+
+    // IRC color code by name, "" if not configured
+    const std::string& color(const std::string& name) const;
+};
+
+// ✅ Current snapshot; safe from any thread
+std::shared_ptr<const Config> config();
+
+// ✅ `text` between a configured color and color_reset, for replies
+std::string colored(const std::string& color, const std::string& text);
+
+// Settings only used on the IRC thread
 extern std::string SERVER;
 extern int PORT;
 extern bool SSL_ENABLED;
@@ -14,9 +43,13 @@ extern std::string GECOS;
 extern std::string SASL_ACCOUNT;
 extern std::string SASL_PASSWORD;
 extern std::string CHANNELS;
-extern std::string GITHUB_API_KEY;
-extern std::string DB_CONN;
-extern std::map<std::string, std::string> IRC_COLORS;
+extern std::string HTTP_CACHE_PATH;
+extern std::string WEBHOOK_BIND;
+extern int WEBHOOK_PORT;
+extern std::string WEBHOOK_SECRET;
+extern std::string WEBHOOK_SPOOL_PATH;
+extern int WEBHOOK_WORKERS;
+extern std::string INGEST_SOCKET_PATH;
 extern std::map<std::string, std::string> COMMIT_COLORS;
 
 void load_config();
@@ -0,0 +1,49 @@
+#ifndef DB_CACHE_H
+#define DB_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// ✅ True while the DbListener is connected; caches are bypassed otherwise, since a
+// change made while nobody was listening would never invalidate them
+bool db_caches_live();
+
+// ✅ In-memory copy of a table, loaded on first use and dropped by invalidate() (called
+// on NOTIFY and after our own writes). A load that races an invalidation is returned
+// but not kept, so a stale copy is never cached.
+template <typename T>
+class InvalidatedCache {
+public:
+    template <typename Load>
+    std::shared_ptr<const T> get(Load load) {
+        uint64_t loading_generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (value && db_caches_live()) {
+                return value;
+            }
+            loading_generation = generation;
+        }
+
+        auto fresh = std::make_shared<const T>(load());
+        std::lock_guard<std::mutex> lock(mutex);
+        if (loading_generation == generation && db_caches_live()) {
+            value = fresh;
+        }
+        return fresh;
+    }
+
+    void invalidate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++generation;
+        value.reset();
+    }
+
+private:
+    std::mutex mutex;
+    std::shared_ptr<const T> value;
+    uint64_t generation = 0;
+};
+
+#endif // DB_CACHE_H
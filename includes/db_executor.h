@@ -0,0 +1,60 @@
+#ifndef DB_EXECUTOR_H
+#define DB_EXECUTOR_H
+
+#include <QMetaObject>
+#include <QObject>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+// ✅ A worker thread with a FIFO work queue, so Postgres (and GitHub HTTP) calls never
+// run on the Qt thread that services the IRC socket. Jobs on one executor run one at
+// a time in submission order; results come back as queued calls on a QObject's thread.
+class DbExecutor {
+public:
+    explicit DbExecutor(std::string name);
+    ~DbExecutor();
+    DbExecutor(const DbExecutor&) = delete;
+    DbExecutor& operator=(const DbExecutor&) = delete;
+
+    void post(std::function<void()> job);
+
+    // Run `work` here, then `done(result)` on `context`'s thread
+    template <typename Work, typename Done>
+    void submit(QObject* context, Work work, Done done) {
+        post([context, work = std::move(work), done = std::move(done)]() mutable {
+            auto result = work();
+            QMetaObject::invokeMethod(context, [done = std::move(done), result = std::move(result)]() mutable {
+                done(std::move(result));
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    size_t pending() const;
+
+private:
+    void run();
+
+    std::string name;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+    std::thread worker;
+};
+
+// ✅ Short database work (IRC commands, webhook and ingest commits), in order
+DbExecutor& db_executor();
+
+// ✅ The poll cycle: GitHub requests plus their database work
+DbExecutor& poll_executor();
+
+// ✅ One-off GitHub requests for IRC commands, so a slow API call holds up neither
+// the database queue nor the poll cycle
+DbExecutor& http_executor();
+
+#endif // DB_EXECUTOR_H
@@ -0,0 +1,35 @@
+#ifndef DB_LISTENER_H
+#define DB_LISTENER_H
+
+#include <QObject>
+#include <memory>
+#include <pqxx/pqxx>
+
+class QSocketNotifier;
+
+// ✅ Dedicated connection LISTENing on `bot_cache`, which triggers on `admins` and
+// `tracked_repos` notify whenever either changes (from any bot instance or by hand).
+// Its socket is watched by the Qt event loop, so caches are dropped as soon as a
+// notification arrives, with no reload polling. A lost connection is retried every
+// few seconds; until then the caches are bypassed.
+class DbListener : public QObject {
+    Q_OBJECT
+
+public:
+    explicit DbListener(QObject* parent = nullptr);
+    ~DbListener();
+
+    void start();
+
+private:
+    class Receiver;
+
+    void onReadable();
+    void disconnectListener();
+
+    std::unique_ptr<pqxx::connection> conn;
+    std::unique_ptr<Receiver> receiver;
+    QSocketNotifier* notifier = nullptr;
+};
+
+#endif // DB_LISTENER_H
@@ -0,0 +1,99 @@
+#ifndef DB_POOL_H
+#define DB_POOL_H
+
+#include "db_statements.h"
+#include <pqxx/pqxx>
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ✅ Fixed-size pool of PostgreSQL connections (db_pool_size, connected lazily).
+// acquire() hands out an idle connection, opens a new one while under the limit, or
+// waits up to db_pool_timeout_ms for one to come back. Connections idle for a while
+// are checked with a round trip before reuse; broken ones are dropped and reopened.
+// The default pool connects to the primary (db_conn); others are given a conninfo.
+class DbPool {
+    // A connection plus the registry statements already prepared on it
+    struct Pooled {
+        std::unique_ptr<pqxx::connection> conn;
+        std::bitset<STATEMENT_COUNT> prepared;
+    };
+
+public:
+    DbPool() = default;
+    explicit DbPool(std::string conninfo) : conninfo(std::move(conninfo)) {}
+
+    // RAII lease; the connection goes back to the pool when the handle is destroyed.
+    // Declare it before any transaction on it so the transaction ends first.
+    class Handle {
+    public:
+        Handle(DbPool* pool, Pooled entry);
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&&) = delete;
+        ~Handle();
+
+        pqxx::connection& operator*() const { return *entry.conn; }
+        pqxx::connection* operator->() const { return entry.conn.get(); }
+
+        // Name of a registry statement, preparing it on this connection first if needed:
+        //   txn.exec_prepared(conn.prepared(Statement::IsAdmin), hostmask)
+        const char* prepared(Statement statement);
+
+        // Keep `owner` (the object holding the pool) alive until the connection is back
+        void hold(std::shared_ptr<const void> owner) { this->owner = std::move(owner); }
+
+        // SQL text that runs a registry statement with quoted arguments, for
+        // pqxx::pipeline (which only takes text). Build it before opening the pipeline,
+        // since the statement may need preparing first.
+        template <typename... Args>
+        std::string execute_sql(pqxx::transaction_base& txn, Statement statement, const Args&... args) {
+            std::string sql = std::string("EXECUTE ") + prepared(statement);
+            if constexpr (sizeof...(Args) > 0) {
+                const char* separator = "(";
+                ((sql.append(separator).append(txn.quote(args)), separator = ", "), ...);
+                sql.append(")");
+            }
+            return sql;
+        }
+
+    private:
+        DbPool* pool;
+        Pooled entry;
+        std::shared_ptr<const void> owner;  // released after the connection is returned
+    };
+
+    // Throws std::runtime_error on timeout, pqxx::broken_connection if connecting fails
+    Handle acquire();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Idle {
+        Pooled pooled;
+        Clock::time_point since;
+    };
+
+    void release(Pooled entry);
+
+    std::string conninfo;  // empty for the primary
+    std::mutex mutex;
+    std::condition_variable returned;
+    std::vector<Idle> idle;  // most recently returned last
+    size_t open = 0;         // idle + leased
+};
+
+// ✅ Process-wide pool used by every database function
+DbPool& db_pool();
+
+// ✅ Connection for read-only statements: the next read replica (db_replica_conns)
+// whose replay lag was last seen within db_replica_max_lag_ms, or the primary when
+// no replica is configured, reachable or caught up. Never write through it.
+// A rehash that changes the replica list takes effect on the next call; removed
+// replicas are closed once their last lease comes back.
+DbPool::Handle db_read();
+
+#endif // DB_POOL_H
@@ -0,0 +1,33 @@
+#ifndef DB_STATEMENTS_H
+#define DB_STATEMENTS_H
+
+#include <cstddef>
+
+// ✅ Registry of the hot queries, run as named prepared statements so Postgres parses
+// and plans each one once per connection instead of on every call. A pooled connection
+// prepares a statement the first time it is used on it (DbPool::Handle::prepared()).
+enum class Statement {
+    IsAdmin,             // $1 hostmask
+    AllAdmins,
+    AddStagedNames,      // repo and author names of commit_staging → dictionaries
+    MergeStagedCommits,  // commit_staging → commits and the stats rollups; returns repo and sha of new rows
+    TrackedRepos,        // name and last_commit_sha of every repo
+    CheckpointRepos,     // $1 repo[], $2 sha[]: last_commit_sha of each
+    SearchCommits,       // $1 terms, $2 repo or NULL, $3..$5 keyset cursor or NULLs, $6 limit
+    RepoStats,           // $1 repo, $2 days: totals and the last $2 days from the rollups
+    TopAuthors,          // $1 repo, $2 limit: most commits first
+    DeliverySeen,        // $1 delivery id
+    RecordDelivery,      // $1 delivery id
+    Count
+};
+
+constexpr std::size_t STATEMENT_COUNT = static_cast<std::size_t>(Statement::Count);
+
+struct StatementText {
+    const char* name;
+    const char* sql;
+};
+
+const StatementText& statement_text(Statement statement);
+
+#endif // DB_STATEMENTS_H
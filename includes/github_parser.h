@@ -0,0 +1,98 @@
+#ifndef GITHUB_PARSER_H
+#define GITHUB_PARSER_H
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ✅ The only commit fields the bot ever reads from a GitHub payload.
+// Fields point straight into the response buffer passed to parse_commits(); only values
+// that needed JSON unescaping (typically multi-line messages) are copied, into the
+// memory resource of the CommitList. A record is valid while both of those live.
+// Copies are never freed individually, so back the list with an arena
+// (std::pmr::monotonic_buffer_resource), not the default heap resource.
+struct CommitRecord {
+    std::string_view sha;
+    std::string_view author;
+    std::string_view message;
+    std::string_view timestamp;
+};
+
+using CommitList = std::pmr::vector<CommitRecord>;
+
+// ✅ Copy a value into an arena so a CommitRecord can point at it
+std::string_view copy_to_arena(std::string_view value, std::pmr::memory_resource* arena);
+
+// ✅ Routing fields of a `push` webhook delivery (views, same lifetime rules as CommitRecord)
+struct PushEvent {
+    std::string_view ref;
+    std::string_view repo;            // repository.full_name
+    std::string_view default_branch;  // repository.default_branch
+};
+
+// ✅ A run of consecutive commits from one push delivery, parsed off the event loop.
+// `event` and `commits` point into `arena`. Not movable; hold it by pointer.
+struct PushBatch {
+    PushBatch() = default;
+    PushBatch(const PushBatch&) = delete;
+    PushBatch& operator=(const PushBatch&) = delete;
+
+    std::pmr::monotonic_buffer_resource arena;
+    PushEvent event;
+    CommitList commits{&arena};
+    bool parsed = true;  // false if the delivery turned out to be malformed
+    bool last = false;   // final batch of its delivery
+
+    // Copy a streamed commit / the routing fields into the arena
+    void add(const CommitRecord& commit);
+    void route(const PushEvent& routing);
+};
+
+// ✅ Incremental parser for push payloads fed in chunks of any size (from the spool or
+// the socket). Each commit is handed to the callback as soon as its object closes;
+// the record's views are only valid during the call. Strings are unescaped on the
+// fly; messages are kept whole (they are stored and searched), other fields are capped
+// at MAX_FIELD_BYTES. Nothing else is retained, so memory is bounded by the current
+// commit however large the payload is.
+class PushStreamParser {
+public:
+    static constexpr std::size_t MAX_FIELD_BYTES = 256;
+
+    explicit PushStreamParser(std::function<void(const CommitRecord&)> on_commit);
+    ~PushStreamParser();
+    PushStreamParser(const PushStreamParser&) = delete;
+    PushStreamParser& operator=(const PushStreamParser&) = delete;
+
+    // Returns false once the input is known to be malformed
+    bool feed(std::string_view chunk);
+    // True if exactly one complete, well-formed JSON document was fed (token order,
+    // literals, number syntax and unescaped control characters are all checked)
+    bool finish();
+
+    // Routing fields seen so far (views valid while the parser lives)
+    PushEvent event() const;
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
+
+// ✅ Extract commits from a REST commit list (`[...]`) or any object with a top-level
+// `commits` array (compare responses, push events) without building a JSON DOM.
+// Returns false if the payload is not valid JSON.
+// Uses simdjson when built with SIMDJSON=1, nlohmann's SAX parser otherwise.
+bool parse_commits(const std::string& payload, CommitList& commits);
+
+// ✅ Extract a push event's routing fields and its commits (oldest → newest)
+bool parse_push_event(const std::string& payload, PushEvent& event, CommitList& commits);
+
+// ✅ Individual backends (exposed for the parse benchmark)
+bool parse_commits_nlohmann(const std::string& payload, CommitList& commits);
+#ifdef BOTHUB_SIMDJSON
+bool parse_commits_simdjson(const std::string& payload, CommitList& commits);
+#endif
+
+#endif // GITHUB_PARSER_H
@@ -0,0 +1,42 @@
+#ifndef HMAC_H
+#define HMAC_H
+
+#include <openssl/evp.h>
+#include <string>
+#include <string_view>
+
+// ✅ HMAC-SHA256 keyed once per secret. The inner/outer pad digests are computed here,
+// so each message only clones this context instead of re-keying.
+class HmacSha256Key {
+public:
+    explicit HmacSha256Key(const std::string& secret);
+    ~HmacSha256Key();
+    HmacSha256Key(const HmacSha256Key&) = delete;
+    HmacSha256Key& operator=(const HmacSha256Key&) = delete;
+
+    bool valid() const { return keyed != nullptr; }
+    EVP_MAC_CTX* clone() const;
+
+private:
+    EVP_MAC* mac = nullptr;
+    EVP_MAC_CTX* keyed = nullptr;
+};
+
+// ✅ Incremental HMAC-SHA256 over a message that arrives in pieces
+class HmacSha256 {
+public:
+    explicit HmacSha256(const HmacSha256Key& key);
+    ~HmacSha256();
+    HmacSha256(const HmacSha256&) = delete;
+    HmacSha256& operator=(const HmacSha256&) = delete;
+
+    void update(const char* data, size_t length);
+
+    // Compare against a GitHub `X-Hub-Signature-256` value ("sha256=<hex>") in constant time
+    bool verify(std::string_view signature_header);
+
+private:
+    EVP_MAC_CTX* ctx;
+};
+
+#endif // HMAC_H
@@ -0,0 +1,47 @@
+#ifndef HTTP_CACHE_H
+#define HTTP_CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// ✅ Validators remembered for a single GitHub API URL
+struct HttpCacheEntry {
+    std::string etag;
+    std::string last_modified;
+    uint64_t body_digest = 0;
+};
+
+// ✅ Append-only on-disk cache of HTTP validators (URL -> ETag, Last-Modified, body digest).
+// The file is memory-mapped once at startup; updates are appended as new records and the
+// file is rewritten (compacted) once stale records outweigh live ones. Thread-safe.
+class HttpCache {
+public:
+    HttpCache() = default;
+    ~HttpCache();
+
+    bool load(const std::string& path);
+    bool find(const std::string& url, HttpCacheEntry& out) const;
+    void store(const std::string& url, const HttpCacheEntry& entry);
+    void compact();
+
+    static uint64_t digest(const std::string& body);
+
+private:
+    bool append_record(const std::string& url, const HttpCacheEntry& entry);
+    void compact_locked();
+    bool open_for_append();
+
+    mutable std::mutex mutex;
+    std::string path;
+    int fd = -1;
+    size_t file_size = 0;
+    size_t live_bytes = 0;
+    std::unordered_map<std::string, HttpCacheEntry> entries;
+};
+
+// ✅ Process-wide cache used by the GitHub poller
+HttpCache& http_cache();
+
+#endif // HTTP_CACHE_H
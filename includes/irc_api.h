@@ -9,6 +9,10 @@
 #include "IrcUtil/irccommandqueue.h"
 #include <QObject>
 #include <QString>
+#include <string>
+#include <string_view>
+
+struct SearchQuery;
 
 class IRCClient : public QObject {
     Q_OBJECT
@@ -21,7 +25,10 @@ public:
     void run();
     void sendRaw(const QString& message);
     void joinChannels();
-    void sendIrcMessage(const std::string& message);
+    void sendIrcMessage(std::string_view message);
+    void flushOutbound();
+    void reply(const QString& target, const std::string& response);
+    void runSearch(const QString& target, const QString& nick, const SearchQuery& query);
 
 signals:
     void disconnected();
@@ -42,6 +49,6 @@ private:
 
 // globally accessible function
 extern IRCClient* global_irc_client;  
-void send_irc_message(const std::string& message);
+void send_irc_message(std::string_view message);
 
 #endif // IRC_API_H
@@ -0,0 +1,39 @@
+#ifndef LOCAL_INGEST_H
+#define LOCAL_INGEST_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <unordered_map>
+
+class QLocalServer;
+class QLocalSocket;
+
+// ✅ Unix domain socket for producers on the same host (CI, mirrors, load generators).
+// Each line is one JSON commit event:
+//   {"repo": "owner/name", "sha": "...", "author": "...", "message": "...", "timestamp": "..."}
+// Events for tracked repos go through the same dedup/store/announce path as polled and
+// webhook commits. Nothing is sent back on success. Malformed lines are answered with an
+// `error: expected ...` line; events that could not be stored (database unavailable) with
+//   error: store failed for owner/name: <sha> <sha> ...
+// once the write has failed, so the producer can resend those events later.
+class LocalIngestServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LocalIngestServer(QObject* parent = nullptr);
+    ~LocalIngestServer();
+
+    bool start(const QString& path);
+
+private slots:
+    void onNewConnection();
+
+private:
+    void onReadyRead(QLocalSocket* socket);
+
+    QLocalServer* server;
+    std::unordered_map<QLocalSocket*, QByteArray> partial_lines;
+};
+
+#endif // LOCAL_INGEST_H
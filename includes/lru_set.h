@@ -0,0 +1,51 @@
+#ifndef LRU_SET_H
+#define LRU_SET_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+// ✅ Bounded set that forgets its least recently seen key first.
+// insert() is O(1) and tells whether the key was new.
+template <typename Key, typename Hash = std::hash<Key>>
+class LruSet {
+public:
+    explicit LruSet(std::size_t capacity) : capacity(capacity) {}
+
+    // Returns false (and refreshes the key) if it was already present
+    bool insert(const Key& key) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            order.splice(order.begin(), order, it->second);
+            return false;
+        }
+
+        order.push_front(key);
+        index.emplace(order.front(), order.begin());
+        if (order.size() > capacity) {
+            index.erase(order.back());
+            order.pop_back();
+        }
+        return true;
+    }
+
+    bool contains(const Key& key) const { return index.count(key) != 0; }
+
+    void erase(const Key& key) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            order.erase(it->second);
+            index.erase(it);
+        }
+    }
+
+    std::size_t size() const { return order.size(); }
+
+private:
+    std::size_t capacity;
+    std::list<Key> order;
+    std::unordered_map<Key, typename std::list<Key>::iterator, Hash> index;
+};
+
+#endif // LRU_SET_H
@@ -0,0 +1,22 @@
+#ifndef POLL_SCHEDULE_H
+#define POLL_SCHEDULE_H
+
+#include <string_view>
+
+// ✅ Per-repo webhook liveness. Repos whose hooks delivered recently are only polled
+// every webhook_verify_interval seconds to verify nothing was missed; once a hook has
+// been quiet for webhook_liveness seconds (or a verification poll finds commits it
+// missed) the repo goes back to polling on every cycle.
+
+enum class PollMode { Normal, Verify, Skip };
+
+// Record a delivery for `repo` (any branch; proves the hook is wired up)
+void note_webhook_delivery(std::string_view repo);
+
+// Decide whether this poller cycle should fetch `repo`
+PollMode poll_mode(std::string_view repo);
+
+// Record a completed poll; `missed` means a verification poll found unannounced commits
+void note_poll(std::string_view repo, PollMode mode, bool missed);
+
+#endif // POLL_SCHEDULE_H
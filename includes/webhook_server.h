@@ -0,0 +1,93 @@
+#ifndef WEBHOOK_SERVER_H
+#define WEBHOOK_SERVER_H
+
+#include "hmac.h"
+#include "lru_set.h"
+#include "webhook_spool.h"
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+struct PushBatch;
+
+class QTcpServer;
+class QTcpSocket;
+
+// ✅ Minimal HTTP/1.1 listener for GitHub webhooks, served from the Qt event loop.
+// Bodies are never buffered: as they stream in they feed X-Hub-Signature-256 and, for
+// `push`, a reserved spool record. A delivery is committed to the spool and
+// acknowledged once the signature checks out. Up to WEBHOOK_WORKERS spooled deliveries
+// are read back in chunks through PushStreamParser on a thread pool; their commits
+// come back to the event loop in small batches and go, in arrival order, to
+// handle_push_event() on the database executor. A delivery whose commits could not be
+// stored stays in the spool and is retried. `ping` is acknowledged; other events are
+// accepted and ignored.
+class WebhookServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit WebhookServer(QObject* parent = nullptr);
+    ~WebhookServer();
+
+    bool start(const QString& address, quint16 port);
+
+private slots:
+    void onNewConnection();
+
+private:
+    struct Request {
+        QByteArray buffer;  // request line and headers only
+        QByteArray method;
+        QByteArray path;
+        QHash<QByteArray, QByteArray> headers;  // lower-cased names
+        qint64 content_length = -1;
+        qint64 body_received = 0;
+        bool headers_done = false;
+        std::unique_ptr<HmacSha256> mac;
+        uint64_t spool_seq = 0;  // reserved spool record, 0 if the body is not kept
+    };
+
+    // A spooled delivery on its way through the worker pool
+    struct Job {
+        uint64_t seq;
+        std::string delivery_id;
+        std::deque<std::shared_ptr<PushBatch>> batches;  // parsed, not yet handled
+        std::shared_ptr<QSemaphore> credits;             // bounds `batches`
+        std::shared_ptr<bool> stored;                    // false once a batch failed; database executor only
+    };
+
+    void onReadyRead(QTcpSocket* socket);
+    bool parseHeaders(Request& request);
+    bool startBody(QTcpSocket* socket, Request& request);
+    void consumeBody(Request& request, const char* data, qint64 size);
+    void handleRequest(QTcpSocket* socket, Request& request);
+    void respond(QTcpSocket* socket, int status, const QByteArray& reason, const QByteArray& body = QByteArray());
+    void forget(QTcpSocket* socket);
+
+    const HmacSha256Key* signingKey();
+
+    void dispatch();
+    void parseDelivery(const SpooledDelivery& delivery, int fd, std::shared_ptr<QSemaphore> credits);
+    void onBatch(uint64_t seq, std::shared_ptr<PushBatch> batch);
+
+    QTcpServer* server;
+    std::unordered_map<QTcpSocket*, Request> requests;
+    LruSet<std::string> recent_deliveries;
+    WebhookSpool spool;
+    std::deque<uint64_t> queued;  // spooled, not yet handed to a worker
+    std::deque<Job> in_flight;    // handed to a worker, applied front to back
+    QThreadPool workers;
+    std::atomic<bool> stopping{false};
+    std::unique_ptr<HmacSha256Key> key;
+    std::string key_secret;
+};
+
+#endif // WEBHOOK_SERVER_H
@@ -0,0 +1,77 @@
+#ifndef WEBHOOK_SPOOL_H
+#define WEBHOOK_SPOOL_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ✅ A spooled webhook delivery: event name, X-GitHub-Delivery and where its body is
+struct SpooledDelivery {
+    uint64_t seq = 0;
+    std::string event;
+    std::string delivery_id;
+    uint64_t payload_offset = 0;
+    uint64_t payload_size = 0;
+};
+
+// ✅ Append-only spool of received webhook deliveries. Room for a delivery is reserved
+// as soon as its headers arrive and the body is written into it as it streams in;
+// the delivery becomes pending on commit(), before it is acknowledged. A done marker is
+// appended once it has been processed, so deliveries still pending after a crash or
+// restart are replayed on the next open(). The file is reset whenever nothing is
+// pending or being received.
+class WebhookSpool {
+public:
+    WebhookSpool() = default;
+    ~WebhookSpool();
+    WebhookSpool(const WebhookSpool&) = delete;
+    WebhookSpool& operator=(const WebhookSpool&) = delete;
+
+    bool open(const std::string& path);
+
+    // Receiving: reserve a record for a body of `payload_size` bytes, fill it, then
+    // commit() it or discard() it (bad signature, duplicate, dropped connection)
+    bool begin(std::string_view event, std::string_view delivery_id, uint64_t payload_size, uint64_t& seq);
+    bool write(uint64_t seq, const char* data, size_t size);
+    bool commit(uint64_t seq);
+    void discard(uint64_t seq);
+
+    // Processing: look a pending delivery up, read its body through reader(), complete()
+    bool locate(uint64_t seq, SpooledDelivery& out) const;
+    void complete(uint64_t seq);
+
+    // Independent descriptor for reading payloads from a worker thread (caller closes it)
+    int reader() const;
+    static bool read_at(int fd, char* data, size_t size, uint64_t offset);
+
+    // Sequence numbers of unprocessed deliveries, oldest first
+    std::vector<uint64_t> pending() const;
+
+private:
+    struct Location {
+        uint64_t offset;  // start of the record body
+        uint32_t size;
+    };
+
+    struct Slot {
+        Location location;
+        uint64_t written;   // body bytes so far
+        uint32_t checksum;  // running checksum of those bytes
+        bool failed;
+    };
+
+    bool append_record(uint32_t kind, const std::string& body);
+    bool rewrite_pending();
+    void reset_if_idle();
+
+    std::string path;
+    int fd = -1;
+    uint64_t file_size = 0;
+    uint64_t next_seq = 1;
+    std::map<uint64_t, Location> pending_records;
+    std::map<uint64_t, Slot> receiving;
+};
+
+#endif // WEBHOOK_SPOOL_H
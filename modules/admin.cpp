@@ -1,15 +1,31 @@
 #include "config.h"
 #include "common.h"
+#include "db_pool.h"
+#include "db_cache.h"
 #include <pqxx/pqxx>
 #include <spdlog/spdlog.h>
+#include <unordered_set>
+
+// ✅ All admin hostmasks, kept while the cache listener is up
+static InvalidatedCache<std::unordered_set<std::string>> admin_cache;
+
+void invalidate_admin_cache() {
+    admin_cache.invalidate();
+}
+
+static std::unordered_set<std::string> load_admins() {
+    auto conn = db_pool().acquire();
+    pqxx::work txn(*conn);
+    std::unordered_set<std::string> admins;
+    for (const auto& row : txn.exec_prepared(conn.prepared(Statement::AllAdmins))) {
+        admins.insert(row[0].as<std::string>());
+    }
+    return admins;
+}
 
 bool is_admin(const std::string& hostmask) {
     try {
-        pqxx::connection conn(DB_CONN);
-        pqxx::work txn(conn);
-        pqxx::result res = txn.exec("SELECT 1 FROM admins WHERE hostmask = " + txn.quote(hostmask) + " LIMIT 1;");
-
-        bool isAdmin = !res.empty();
+        bool isAdmin = admin_cache.get(load_admins)->count(hostmask) != 0;
         spdlog::info("🔍 Admin check for {}: {}", hostmask, isAdmin ? "YES" : "NO");
 
         return isAdmin;
@@ -21,90 +37,94 @@ bool is_admin(const std::string& hostmask) {
 
 std::string add_admin(const std::string& sender_hostmask, const std::string& new_admin_hostmask) {
     if (!is_admin(sender_hostmask)) {
-        return IRC_COLORS["color_red"] + "⚠️ You are not authorized to add admins." + IRC_COLORS["color_reset"];
+        return colored("color_red", "⚠️ You are not authorized to add admins.");
     }
 
     try {
-        pqxx::connection conn(DB_CONN);
-        pqxx::work txn(conn);
+        auto conn = db_pool().acquire();
+        pqxx::work txn(*conn);
 
         // Check if admin already exists
-        pqxx::result res = txn.exec("SELECT 1 FROM admins WHERE hostmask = " + txn.quote(new_admin_hostmask) + " LIMIT 1;");
+        pqxx::result res = txn.exec_prepared(conn.prepared(Statement::IsAdmin), new_admin_hostmask);
 
         if (!res.empty()) {
-            return IRC_COLORS["color_yellow"] + "⚠️ " + new_admin_hostmask + " is already an admin." + IRC_COLORS["color_reset"];
+            return colored("color_yellow", "⚠️ " + new_admin_hostmask + " is already an admin.");
         }
 
         // Insert new admin if not found
-        txn.exec("INSERT INTO admins (hostmask) VALUES (" + txn.quote(new_admin_hostmask) + ");");
+        txn.exec_params("INSERT INTO admins (hostmask) VALUES ($1);", new_admin_hostmask);
         txn.commit();
+        invalidate_admin_cache();  // the NOTIFY reaches other instances
 
-        return IRC_COLORS["color_green"] + "✅ Admin added: " + new_admin_hostmask + IRC_COLORS["color_reset"];
+        return colored("color_green", "✅ Admin added: " + new_admin_hostmask);
     } catch (const std::exception& e) {
         spdlog::error("❌ Error adding admin: {}", e.what());
-        return IRC_COLORS["color_red"] + "⚠️ Failed to add admin." + IRC_COLORS["color_reset"];
+        return colored("color_red", "⚠️ Failed to add admin.");
     }
 }
 
 std::string remove_admin(const std::string& sender_hostmask, const std::string& target_hostmask) {
     if (!is_admin(sender_hostmask)) {
-        return IRC_COLORS["color_red"] + "⚠️ You are not authorized to remove admins." + IRC_COLORS["color_reset"];
+        return colored("color_red", "⚠️ You are not authorized to remove admins.");
     }
 
     try {
-        pqxx::connection conn(DB_CONN);
-        pqxx::work txn(conn);
-        txn.exec("DELETE FROM admins WHERE hostmask = " + txn.quote(target_hostmask) + ";");
+        auto conn = db_pool().acquire();
+        pqxx::work txn(*conn);
+        txn.exec_params("DELETE FROM admins WHERE hostmask = $1;", target_hostmask);
         txn.commit();
+        invalidate_admin_cache();
 
-        return IRC_COLORS["color_red"] + "❌ Admin removed: " + target_hostmask + IRC_COLORS["color_reset"];
+        return colored("color_red", "❌ Admin removed: " + target_hostmask);
     } catch (const std::exception& e) {
         spdlog::error("❌ Error removing admin: {}", e.what());
-        return IRC_COLORS["color_red"] + "⚠️ Failed to remove admin." + IRC_COLORS["color_reset"];
+        return colored("color_red", "⚠️ Failed to remove admin.");
     }
 }
 
 // ✅ Add repository to tracking
 std::string add_repo(const std::string& sender_hostmask, const std::string& repo) {
     if (!is_admin(sender_hostmask)) {
-        return IRC_COLORS["color_red"] + "⚠️ You are not authorized to add repositories." + IRC_COLORS["color_reset"];
+        return colored("color_red", "⚠️ You are not authorized to add repositories.");
     }
 
     try {
-        pqxx::connection conn(DB_CONN);
-        pqxx::work txn(conn);
+        auto conn = db_pool().acquire();
+        pqxx::work txn(*conn);
 
         // ✅ Check if repo is already in the database
         pqxx::result res = txn.exec_params("SELECT 1 FROM tracked_repos WHERE repo_name = $1", repo);
         if (!res.empty()) {
-            return IRC_COLORS["color_yellow"] + "⚠️ Repository already being tracked: " + repo + IRC_COLORS["color_reset"];
+            return colored("color_yellow", "⚠️ Repository already being tracked: " + repo);
         }
 
         // ✅ Insert new repo
         txn.exec_params("INSERT INTO tracked_repos (repo_name) VALUES ($1)", repo);
         txn.commit();
+        invalidate_tracked_repo_cache();
 
-        return IRC_COLORS["color_green"] + "✅ Repository added: " + repo + IRC_COLORS["color_reset"];
+        return colored("color_green", "✅ Repository added: " + repo);
     } catch (const std::exception& e) {
         spdlog::error("❌ Database error in add_repo: {}", e.what());
-        return IRC_COLORS["color_red"] + "❌ Error adding repository." + IRC_COLORS["color_reset"];
+        return colored("color_red", "❌ Error adding repository.");
     }
 }
 
 // ✅ Remove repository from tracking
 std::string remove_repo(const std::string& sender_hostmask, const std::string& repo) {
     if (!is_admin(sender_hostmask)) {
-        return IRC_COLORS["color_red"] + "⚠️ You are not authorized to remove repositories." + IRC_COLORS["color_reset"];
+        return colored("color_red", "⚠️ You are not authorized to remove repositories.");
     }
 
     try {
-        pqxx::connection conn(DB_CONN);
-        pqxx::work txn(conn);
-        txn.exec("DELETE FROM tracked_repos WHERE repo_name = " + txn.quote(repo) + ";");
+        auto conn = db_pool().acquire();
+        pqxx::work txn(*conn);
+        txn.exec_params("DELETE FROM tracked_repos WHERE repo_name = $1;", repo);
         txn.commit();
-        return IRC_COLORS["color_red"] + "❌ Repository removed: " + repo + IRC_COLORS["color_reset"];
+        invalidate_tracked_repo_cache();
+        return colored("color_red", "❌ Repository removed: " + repo);
     } catch (const std::exception& e) {
         spdlog::error("Error removing repo: {}", e.what());
-        return IRC_COLORS["color_red"] + "⚠️ Failed to remove repository." + IRC_COLORS["color_reset"];
+        return colored("color_red", "⚠️ Failed to remove repository.");
     }
 }
@@ -1,75 +1,234 @@
 #include "common.h"
+#include "config.h"
+#include "db_pool.h"
+#include "db_executor.h"
 #include <pqxx/pqxx>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <unordered_set>
 
 void initialize_database() {
     try {
-        spdlog::info("🔍 Attempting to connect to database with: {}", DB_CONN);
+        spdlog::info("🔍 Attempting to connect to database with: {}", config()->db_conn);
 
-        pqxx::connection conn(DB_CONN);
-        if (conn.is_open()) {
-            spdlog::info("✅ Connected to PostgreSQL database: {}", conn.dbname());
+        auto conn = db_pool().acquire();
+        if (conn->is_open()) {
+            spdlog::info("✅ Connected to PostgreSQL database: {}", conn->dbname());
         } else {
             spdlog::error("❌ Failed to connect to database!");
             return;
         }
 
-        pqxx::work txn(conn);
-        txn.exec(R"(
-            CREATE TABLE IF NOT EXISTS admins (
-                id SERIAL PRIMARY KEY,
-                hostmask TEXT UNIQUE NOT NULL
-            );
-            CREATE TABLE IF NOT EXISTS commits (
-                id SERIAL PRIMARY KEY,
-                repo_name TEXT NOT NULL,
-                sha TEXT NOT NULL,
-                author TEXT NOT NULL,
-                message TEXT NOT NULL,
-                url TEXT NOT NULL,
-                additions INT DEFAULT 0,
-                deletions INT DEFAULT 0,
-                changes INT DEFAULT 0
-            );
-        )");
-        txn.commit();
+        run_migrations();
+        maintain_database();
         spdlog::info("✅ Database initialized successfully.");
     } catch (const std::exception& e) {
         spdlog::error("❌ Database initialization error: {}", e.what());
     }
 }
 
-void store_commit_info(const std::string& repo, const std::string& sha, const std::string& author, 
-                       const std::string& message, const std::string& url, int additions, 
-                       int deletions, int changes) {
+// ✅ Housekeeping run at startup and daily: create the coming months' commit partitions,
+// drop the ones past the retention (0 months keeps everything), prune delivery IDs
+void maintain_database() {
     try {
-        pqxx::connection conn(DB_CONN);
-        pqxx::work txn(conn);
-
-        txn.exec_params(
-            "INSERT INTO commits (repo_name, sha, author, commit_hash, message, timestamp) "
-            "VALUES ($1, $2, $3, $4, $5, CURRENT_TIMESTAMP) "
-            "ON CONFLICT (commit_hash) DO NOTHING;",  // Prevent duplicate commits
-            repo, sha, author, sha, message
-        );
-
+        auto settings = config();
+        auto conn = db_pool().acquire();
+        pqxx::work txn(*conn);
+        txn.exec_params("SELECT ensure_commit_partitions($1);", std::max(1, settings->commit_partitions_ahead));
+        if (settings->commit_retention_months > 0) {
+            int months = settings->commit_retention_months;
+            int dropped = txn.exec_params("SELECT drop_commit_partitions($1);", months)[0][0].as<int>();
+            if (dropped > 0) {
+                spdlog::info("🧹 Dropped {} commit partition(s) older than {} months", dropped, months);
+            }
+        }
+        txn.exec("DELETE FROM webhook_deliveries WHERE received_at < now() - INTERVAL '7 days';");
         txn.commit();
-        spdlog::info("✅ Commit stored: [{}] {} - {}", repo, sha, message);
     } catch (const std::exception& e) {
-        spdlog::error("❌ Database error while storing commit: {}", e.what());
+        spdlog::error("❌ Database maintenance error: {}", e.what());
     }
 }
 
-bool is_commit_stored(const std::string& repo, const std::string& sha) {
+void start_database_maintenance() {
+    QTimer* timer = new QTimer();
+    QObject::connect(timer, &QTimer::timeout, []() { db_executor().post(maintain_database); });
+    timer->start(24 * 60 * 60 * 1000);  // Daily
+}
+
+// ✅ Write a batch of commits and the checkpoints that go with it in one transaction.
+// The commits are streamed (COPY) into a per-session staging table, then their repo and
+// author names are added to the dictionaries and they are merged into `commits`, in the
+// same pipelined round trip as the checkpoints. inserted[i] is set for each commit that
+// was not stored before. Throws on database errors.
+void store_commits(const std::vector<PendingCommit>& commits, const std::vector<RepoCheckpoint>& checkpoints,
+                   std::vector<bool>& inserted) {
+    inserted.assign(commits.size(), false);
+
+    auto conn = db_pool().acquire();
+    pqxx::work txn(*conn);
+
+    std::unordered_set<std::string> new_keys;
+    if (!commits.empty()) {
+        txn.exec("CREATE TEMP TABLE IF NOT EXISTS commit_staging ("
+                 "repo_name TEXT NOT NULL, sha TEXT NOT NULL, author TEXT NOT NULL, committed_at TEXT NOT NULL, "
+                 "message TEXT NOT NULL"
+                 ") ON COMMIT DELETE ROWS;");
+
+        auto stream = pqxx::stream_to::table(txn, {"commit_staging"},
+                                             {"repo_name", "sha", "author", "committed_at", "message"});
+        for (const PendingCommit& pending : commits) {
+            stream.write_values(pending.repo, pending.commit.sha, pending.commit.author, pending.commit.timestamp,
+                                pending.commit.message);
+        }
+        stream.complete();
+    }
+
+    // ✅ The merge and the checkpoints of every repo (one set-based UPDATE) go out together
+    std::vector<std::string> queries;
+    if (!commits.empty()) {
+        queries.push_back(conn.execute_sql(txn, Statement::AddStagedNames));
+        queries.push_back(conn.execute_sql(txn, Statement::MergeStagedCommits));
+    }
+    if (!checkpoints.empty()) {
+        std::vector<std::string> repos;
+        std::vector<std::string> shas;
+        for (const RepoCheckpoint& checkpoint : checkpoints) {
+            repos.push_back(checkpoint.repo);
+            shas.push_back(checkpoint.sha);
+        }
+        queries.push_back(conn.execute_sql(txn, Statement::CheckpointRepos, repos, shas));
+    }
+
+    std::vector<pqxx::pipeline::query_id> ids;
+    {
+        pqxx::pipeline pipe(txn);
+        for (const std::string& query : queries) {
+            ids.push_back(pipe.insert(query));
+        }
+        pipe.complete();
+        if (!commits.empty()) {
+            pipe.retrieve(ids[0]);
+            for (const auto& row : pipe.retrieve(ids[1])) {
+                new_keys.insert(row[0].as<std::string>() + "@" + row[1].as<std::string>());
+            }
+        }
+        if (!checkpoints.empty()) {
+            pipe.retrieve(ids.back());  // rethrows a failed checkpoint
+        }
+    }
+    txn.commit();
+
+    std::string key;
+    for (size_t i = 0; i < commits.size(); ++i) {
+        key.assign(commits[i].repo).append("@").append(commits[i].commit.sha);
+        inserted[i] = new_keys.count(key) != 0;
+    }
+    spdlog::info("✅ Stored {} of {} commit(s)", new_keys.size(), commits.size());
+}
+
+// ✅ One page of matches, rendered for IRC. Fetches one extra row to know whether a next
+// page exists. Throws on database errors.
+SearchPage search_commits(const SearchQuery& query, size_t page_size) {
+    auto conn = db_read();
+    pqxx::read_transaction txn(*conn);
+
+    std::optional<std::string> repo;
+    if (!query.repo.empty()) {
+        repo = query.repo;
+    }
+    std::optional<std::string> after_time, after_sha;
+    std::optional<int> after_repo;
+    if (query.after) {
+        after_time = query.after->committed_at;
+        after_repo = query.after->repo_id;
+        after_sha = query.after->sha;
+    }
+
+    pqxx::result res = txn.exec_prepared(conn.prepared(Statement::SearchCommits), query.terms, repo, after_time,
+                                         after_repo, after_sha, static_cast<int>(page_size + 1));
+
+    SearchPage page;
+    for (size_t i = 0; i < res.size() && i < page_size; ++i) {
+        const auto& row = res[i];
+        std::string sha = row[1].as<std::string>();
+        std::string committed_at = row[4].as<std::string>();
+        std::string_view message = row[3].view();
+        message = message.substr(0, message.find('\n'));
+        page.lines.push_back("[" + row[0].as<std::string>() + "] " + row[2].as<std::string>() + " " +
+                             sha.substr(0, 7) + " (" + committed_at.substr(0, 10) + ") - " + std::string(message));
+        if (i + 1 == page_size && res.size() > page_size) {
+            page.next = SearchCursor{committed_at, row[5].as<int>(), sha};
+        }
+    }
+    return page;
+}
+
+// ✅ Totals plus the last `days` days, read from one rollup row per active day
+std::string repo_commit_stats(const std::string& repo, int days) {
+    auto conn = db_read();
+    pqxx::read_transaction txn(*conn);
+    pqxx::result res = txn.exec_prepared(conn.prepared(Statement::RepoStats), repo, days);
+    if (res.empty()) {
+        return "";
+    }
+
+    const auto& row = res[0];
+    std::string line = "📊 " + row[0].as<std::string>() + ": ";
+    long long recent = row[4].as<long long>();
+    if (recent == 0) {
+        line += "no commits in the last " + std::to_string(days) + " day(s)";
+    } else {
+        line += std::to_string(recent) + " commit(s) in the last " + std::to_string(days) + " day(s) on " +
+                row[5].as<std::string>() + " active day(s), busiest " + row[6].as<std::string>() + " (" +
+                row[7].as<std::string>() + ")";
+    }
+    line += " · " + row[1].as<std::string>() + " total from " + row[2].as<std::string>() + " to " +
+            row[3].as<std::string>();
+    return line;
+}
+
+// ✅ Authors with the most commits to a repo, with their share of its total
+std::string top_committers(const std::string& repo, size_t limit) {
+    auto conn = db_read();
+    pqxx::read_transaction txn(*conn);
+    pqxx::result res = txn.exec_prepared(conn.prepared(Statement::TopAuthors), repo, static_cast<int>(limit));
+    if (res.empty()) {
+        return "";
+    }
+
+    std::string line = "🏆 Top committers in " + res[0][0].as<std::string>() + ":";
+    const char* separator = " ";
+    for (const auto& row : res) {
+        long long commits = row[2].as<long long>();
+        long long total = std::max(1LL, row[3].as<long long>());
+        line += separator + row[1].as<std::string>() + " " + std::to_string(commits) + " (" +
+                std::to_string(commits * 100 / total) + "%)";
+        separator = ", ";
+    }
+    return line;
+}
+
+// ✅ Was this webhook delivery ID processed before?
+bool webhook_delivery_seen(const std::string& delivery_id) {
     try {
-        pqxx::connection conn(DB_CONN);
-        pqxx::work txn(conn);
-        pqxx::result res = txn.exec(
-            "SELECT 1 FROM commits WHERE repo_name = " + txn.quote(repo) + " AND sha = " + txn.quote(sha) + " LIMIT 1;"
-        );
+        auto conn = db_pool().acquire();
+        pqxx::work txn(*conn);
+        pqxx::result res = txn.exec_prepared(conn.prepared(Statement::DeliverySeen), delivery_id);
         return !res.empty();
     } catch (const std::exception& e) {
-        spdlog::error("❌ Database error while checking commit: {}", e.what());
+        spdlog::error("❌ Database error while checking webhook delivery: {}", e.what());
         return false;
     }
 }
+
+// ✅ Remember a processed webhook delivery ID (after processing, so a crash replays it)
+void record_webhook_delivery(const std::string& delivery_id) {
+    try {
+        auto conn = db_pool().acquire();
+        pqxx::work txn(*conn);
+        txn.exec_prepared(conn.prepared(Statement::RecordDelivery), delivery_id);
+        txn.commit();
+    } catch (const std::exception& e) {
+        spdlog::error("❌ Database error while recording webhook delivery: {}", e.what());
+    }
+}
@@ -0,0 +1,84 @@
+#include "db_listener.h"
+#include "common.h"
+#include "config.h"
+#include "db_cache.h"
+#include <spdlog/spdlog.h>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <atomic>
+
+static const int RECONNECT_DELAY_MS = 5000;
+static const char* CACHE_CHANNEL = "bot_cache";
+
+static std::atomic<bool> caches_live{false};
+
+bool db_caches_live() {
+    return caches_live;
+}
+
+// ✅ The payload names the table that changed
+class DbListener::Receiver : public pqxx::notification_receiver {
+public:
+    explicit Receiver(pqxx::connection& conn) : pqxx::notification_receiver(conn, CACHE_CHANNEL) {}
+
+    void operator()(const std::string& payload, int) override {
+        spdlog::debug("🔔 Cache invalidation: {}", payload);
+        if (payload == "admins") {
+            invalidate_admin_cache();
+        } else if (payload == "tracked_repos") {
+            invalidate_tracked_repo_cache();
+        }
+    }
+};
+
+DbListener::DbListener(QObject* parent) : QObject(parent) {}
+
+DbListener::~DbListener() {
+    disconnectListener();
+}
+
+// ✅ Open the connection and LISTEN; on failure try again later
+void DbListener::start() {
+    try {
+        conn = std::make_unique<pqxx::connection>(config()->db_conn);
+        receiver = std::make_unique<Receiver>(*conn);  // issues LISTEN
+    } catch (const std::exception& e) {
+        spdlog::warn("⚠️ Cache listener could not connect, retrying: {}", e.what());
+        disconnectListener();
+        QTimer::singleShot(RECONNECT_DELAY_MS, this, &DbListener::start);
+        return;
+    }
+
+    notifier = new QSocketNotifier(conn->sock(), QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, [this]() { onReadable(); });
+
+    // ✅ Nothing cached before this point was covered by a listener
+    invalidate_admin_cache();
+    invalidate_tracked_repo_cache();
+    caches_live = true;
+    spdlog::info("✅ Listening for cache invalidations on '{}'", CACHE_CHANNEL);
+}
+
+void DbListener::onReadable() {
+    try {
+        conn->get_notifs();
+    } catch (const std::exception& e) {
+        spdlog::warn("⚠️ Cache listener connection lost, retrying: {}", e.what());
+        disconnectListener();
+        QTimer::singleShot(RECONNECT_DELAY_MS, this, &DbListener::start);
+    }
+}
+
+void DbListener::disconnectListener() {
+    caches_live = false;
+    invalidate_admin_cache();
+    invalidate_tracked_repo_cache();
+
+    if (notifier) {
+        notifier->setEnabled(false);
+        notifier->deleteLater();  // may be inside its own activated() signal
+        notifier = nullptr;
+    }
+    receiver.reset();
+    conn.reset();
+}
@@ -1,28 +1,41 @@
 #include "common.h"
 #include "config.h"
 #include "irc_api.h"
+#include "http_cache.h"
+#include "github_parser.h"
+#include "lru_set.h"
+#include "poll_schedule.h"
+#include "db_pool.h"
+#include "db_executor.h"
+#include "db_cache.h"
 #include <cpr/cpr.h>
-#include <nlohmann/json.hpp>
 #include <pqxx/pqxx>
 #include <spdlog/spdlog.h>
 #include <QObject>
 #include <QTimer>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <mutex>
+#include <memory_resource>
+#include <unordered_map>
 
-using json = nlohmann::json;
+// ✅ Backing store for the per-cycle arena; cycles that outgrow it spill to the heap
+static std::array<std::byte, 256 * 1024> cycle_buffer;
 
-// ✅ Get the list of tracked repositories from the database
-std::vector<std::string> get_tracked_repos() {
-    std::vector<std::string> repos;
+// ✅ Get the tracked repositories and their last processed commits in one query
+std::vector<TrackedRepo> get_tracked_repos() {
+    std::vector<TrackedRepo> repos;
     try {
-        pqxx::connection conn(DB_CONN);
-        pqxx::work txn(conn);
+        auto conn = db_pool().acquire();
+        pqxx::work txn(*conn);
 
-        pqxx::result res = txn.exec("SELECT repo_name FROM tracked_repos;");
+        pqxx::result res = txn.exec_prepared(conn.prepared(Statement::TrackedRepos));
         for (const auto& row : res) {
-            std::string repo = row[0].as<std::string>();
-            repos.push_back(repo);
-            spdlog::info("Tracked repo from DB: {}", repo);
+            TrackedRepo repo{row[0].as<std::string>(), row[1].is_null() ? std::string() : row[1].as<std::string>()};
+            spdlog::info("Tracked repo from DB: {}", repo.name);
+            repos.push_back(std::move(repo));
         }
     } catch (const std::exception& e) {
         spdlog::error("Error fetching tracked repositories: {}", e.what());
@@ -30,114 +43,402 @@ std::vector<std::string> get_tracked_repos() {
     return repos;
 }
 
+// ✅ Conditional GET: replay cached ETag / Last-Modified so unchanged resources cost a 304
+static cpr::Response fetch_github(const std::string& url) {
+    cpr::Header headers = {{"User-Agent", "C++-GitHub-Bot"}};
+    std::string api_key = config()->github_api_key;
+    if (!api_key.empty()) {
+        headers["Authorization"] = "token " + api_key;
+    }
+
+    HttpCacheEntry cached;
+    if (http_cache().find(url, cached)) {
+        if (!cached.etag.empty()) {
+            headers["If-None-Match"] = cached.etag;
+        }
+        if (!cached.last_modified.empty()) {
+            headers["If-Modified-Since"] = cached.last_modified;
+        }
+    }
+
+    return cpr::Get(cpr::Url{url}, headers);
+}
+
+// ✅ Validators of a 200 response, to be remembered once it is fully processed
+static HttpCacheEntry cache_entry(const cpr::Response& response, uint64_t body_digest) {
+    HttpCacheEntry entry;
+    auto etag = response.header.find("ETag");
+    if (etag != response.header.end()) {
+        entry.etag = etag->second;
+    }
+    auto last_modified = response.header.find("Last-Modified");
+    if (last_modified != response.header.end()) {
+        entry.last_modified = last_modified->second;
+    }
+    entry.body_digest = body_digest;
+    return entry;
+}
+
+// Announced messages are cut here (on a UTF-8 boundary); the stored message is whole
+static const size_t ANNOUNCE_MESSAGE_BYTES = 8 * 1024;
+
+static std::string_view announced_message(std::string_view message) {
+    if (message.size() <= ANNOUNCE_MESSAGE_BYTES) {
+        return message;
+    }
+    size_t end = ANNOUNCE_MESSAGE_BYTES;
+    while (end > 0 && (static_cast<unsigned char>(message[end]) & 0xC0) == 0x80) {
+        --end;
+    }
+    return message.substr(0, end);
+}
+
+// ✅ Render "[repo] author sha7 - message (https://github.com/repo/commit/sha)" straight
+// from the record's views with a single allocation from the arena
+static std::pmr::string render_commit_line(std::string_view repo, const CommitRecord& commit,
+                                           std::pmr::memory_resource* arena) {
+    static constexpr std::string_view url_prefix = "https://github.com/";
+    static constexpr std::string_view url_infix = "/commit/";
+
+    std::string_view short_sha = commit.sha.substr(0, 7);
+    std::string_view message = announced_message(commit.message);
+    std::pmr::string line(arena);
+    line.reserve(2 * repo.size() + commit.author.size() + short_sha.size() + message.size() +
+                 url_prefix.size() + url_infix.size() + commit.sha.size() + 10);
+    line.append("[").append(repo).append("] ").append(commit.author).append(" ").append(short_sha)
+        .append(" - ").append(message)
+        .append(" (").append(url_prefix).append(repo).append(url_infix).append(commit.sha).append(")");
+    return line;
+}
+
+// ✅ Recently published "repo@sha" keys; the commits unique index is the durable backstop.
+// Shared by the poller and database executors.
+static LruSet<std::string> recent_commits(4096);
+static std::mutex recent_commits_mutex;
+
+static bool first_sighting(const std::string& key) {
+    std::lock_guard<std::mutex> lock(recent_commits_mutex);
+    return recent_commits.insert(key);
+}
+
+// Give keys back when their write failed, so the retry is not skipped as a repeat
+static void forget_sightings(const std::vector<PendingCommit>& commits) {
+    std::lock_guard<std::mutex> lock(recent_commits_mutex);
+    std::string key;
+    for (const PendingCommit& pending : commits) {
+        key.assign(pending.repo).append("@").append(pending.commit.sha);
+        recent_commits.erase(key);
+    }
+}
+
+// ✅ Commits of one poll cycle, push batch or ingest read, stored with one write
+// (store_commits) and then announced oldest → newest; shared by the poller and webhooks.
+// Records are copied into the arena, so their payloads need not outlive the batch.
+class CommitBatch {
+public:
+    explicit CommitBatch(std::pmr::memory_resource* arena) : arena(arena) {}
+
+    // A commit seen through both paths, or redelivered, is dropped before touching the DB
+    void add(std::string_view repo, const CommitList& commits) {
+        std::string_view kept_repo = copy_to_arena(repo, arena);
+        std::string key;
+        for (const CommitRecord& commit : commits) {
+            key.assign(repo).append("@").append(commit.sha);
+            if (!first_sighting(key)) {
+                spdlog::debug("Skipping already published commit {}", key);
+                continue;
+            }
+            pending.push_back(PendingCommit{kept_repo, CommitRecord{copy_to_arena(commit.sha, arena),
+                                                                    copy_to_arena(commit.author, arena),
+                                                                    copy_to_arena(commit.message, arena),
+                                                                    copy_to_arena(commit.timestamp, arena)}});
+        }
+    }
+
+    void checkpoint(std::string_view repo, std::string_view sha) {
+        checkpoints.push_back(RepoCheckpoint{std::string(repo), std::string(sha)});
+    }
+
+    // ✅ Store, then announce what was new. If the write fails nothing is announced, the
+    // commits are released from the recent-commit set and false is returned (checkpoints
+    // were not saved), so the next poll or the spooled webhook retry picks them up again.
+    bool flush() {
+        if (pending.empty() && checkpoints.empty()) {
+            return true;
+        }
+
+        std::vector<bool> inserted;
+        try {
+            store_commits(pending, checkpoints, inserted);
+        } catch (const std::exception& e) {
+            spdlog::error("❌ Database error while storing {} commit(s): {}", pending.size(), e.what());
+            forget_sightings(pending);
+            pending.clear();
+            checkpoints.clear();
+            return false;
+        }
+
+        for (size_t i = 0; i < pending.size(); ++i) {
+            const PendingCommit& commit = pending[i];
+            if (!inserted[i]) {
+                spdlog::info("🔁 Commit already stored: [{}] {}", commit.repo, commit.commit.sha);
+                continue;
+            }
+            send_irc_message(render_commit_line(commit.repo, commit.commit, arena));
+            ++announced_by_repo[std::string(commit.repo)];
+        }
+        for (const RepoCheckpoint& checkpoint : checkpoints) {
+            spdlog::info("Updated last commit for {} to {}", checkpoint.repo, checkpoint.sha);
+        }
+
+        pending.clear();
+        checkpoints.clear();
+        return true;
+    }
+
+    // Commits of `repo` announced by flush()
+    size_t announced(const std::string& repo) const {
+        auto it = announced_by_repo.find(repo);
+        return it == announced_by_repo.end() ? 0 : it->second;
+    }
+
+private:
+    std::pmr::memory_resource* arena;
+    std::vector<PendingCommit> pending;
+    std::vector<RepoCheckpoint> checkpoints;
+    std::unordered_map<std::string, size_t> announced_by_repo;
+};
+
+// ✅ The cycle runs on the poller executor; a tick arriving while one is still running is skipped
+static std::atomic<bool> cycle_running{false};
+
 void start_commit_checker() {
     spdlog::info("Starting commit checker every 2 minutes...");
     QTimer* timer = new QTimer();
     QObject::connect(timer, &QTimer::timeout, []() {
-        check_for_new_commits();
+        if (cycle_running.exchange(true)) {
+            spdlog::warn("⚠️ Previous commit check still running, skipping this one.");
+            return;
+        }
+        poll_executor().post([]() {
+            check_for_new_commits();
+            cycle_running = false;
+        });
     });
     timer->start(120000);  // Check every 2 minutes
 }
 
-// ✅ Fetch the latest commit from GitHub API and send it to IRC
+// ✅ A repo whose poll returned new data, settled once the cycle's commits are stored
+struct PolledRepo {
+    const std::string* repo;
+    PollMode mode;
+    std::string url;
+    HttpCacheEntry validators;
+};
+
+// ✅ Fetch new commits of every tracked repo, store them with one write, announce them
 void check_for_new_commits() {
-    std::vector<std::string> repos = get_tracked_repos();
+    std::vector<TrackedRepo> repos = get_tracked_repos();
+
+    // ✅ Parsed records and rendered lines of this cycle; released in one step on return
+    std::pmr::monotonic_buffer_resource arena(cycle_buffer.data(), cycle_buffer.size());
+    CommitBatch batch(&arena);
+    std::vector<PolledRepo> polled;
+
+    for (const TrackedRepo& tracked : repos) {
+        const std::string& repo = tracked.name;
+        const std::string& last_commit_sha = tracked.last_commit_sha;
+        PollMode mode = poll_mode(repo);
+        if (mode == PollMode::Skip) {
+            continue;
+        }
 
-    for (const std::string& repo : repos) {
         try {
-            pqxx::connection conn(DB_CONN);
-            pqxx::work txn(conn);
-
-            // ✅ Get last processed commit from the database with null check
-            pqxx::result res = txn.exec_params("SELECT last_commit_sha FROM tracked_repos WHERE repo_name = $1;", repo);
-            std::string last_commit_sha = "";
-            if (!res.empty() && !res[0][0].is_null()) {
-                last_commit_sha = res[0][0].as<std::string>();
-            }
 
             // ✅ Fetch the last 3 commits from GitHub
             std::string url = "https://api.github.com/repos/" + repo + "/commits?per_page=3";
-            cpr::Header headers = {{"User-Agent", "C++-GitHub-Bot"}};
-            if (!GITHUB_API_KEY.empty()) {
-                headers["Authorization"] = "token " + GITHUB_API_KEY;
-            }
+            auto response = fetch_github(url);
 
-            auto response = cpr::Get(cpr::Url{url}, headers);
+            if (response.status_code == 304) {
+                spdlog::debug("No changes for {} (304 Not Modified)", repo);
+                note_poll(repo, mode, false);
+                continue;
+            }
 
             if (response.status_code == 200) {
-                json commits = json::parse(response.text);
-                bool found_new_commit = false;
-                std::vector<std::string> new_commits;
+                // ✅ Same body as last time (validators rotated without new commits)
+                uint64_t body_digest = HttpCache::digest(response.text);
+                HttpCacheEntry cached;
+                if (http_cache().find(url, cached) && cached.body_digest == body_digest) {
+                    http_cache().store(url, cache_entry(response, body_digest));
+                    note_poll(repo, mode, false);
+                    continue;
+                }
 
-                for (const auto& commit : commits) {
-                    std::string sha = commit["sha"].get<std::string>();
-                    std::string author = commit["commit"]["author"]["name"].get<std::string>();
-                    std::string message = commit["commit"]["message"].get<std::string>();
-                    std::string commit_url = "https://github.com/" + repo + "/commit/" + sha;
+                CommitList commits(&arena);
+                if (!parse_commits(response.text, commits)) {
+                    spdlog::error("Malformed commit list for {}", repo);
+                    note_poll(repo, mode, false);
+                    continue;
+                }
 
-                    // Stop if we reach the last known commit
-                    if (sha == last_commit_sha) {
+                // ✅ Everything newer than the last known commit, oldest → newest
+                CommitList new_commits(&arena);
+                for (const auto& commit : commits) {
+                    if (commit.sha == last_commit_sha) {
                         break;
                     }
-
-                    found_new_commit = true;
-
-                    // ✅ Store commit in database
-                    store_commit_info(repo, sha, author, message, commit_url, 0, 0, 0);
-
-                    // ✅ Build plain text IRC message
-                    std::string irc_message = "[" + repo + "] " + author + " " + sha.substr(0, 7) +
-                                              " - " + message + " (" + commit_url + ")";
-                    new_commits.push_back(irc_message);
+                    new_commits.push_back(commit);
                 }
-
-                // ✅ Send messages in chronological order (oldest → newest)
                 std::reverse(new_commits.begin(), new_commits.end());
-                for (const auto& msg : new_commits) {
-                    send_irc_message(msg);
-                }
+                batch.add(repo, new_commits);
 
                 // ✅ Update last known commit only if new commits were found
-                if (found_new_commit && !commits.empty()) {
-                    std::string new_commit_sha = commits[0]["sha"].get<std::string>();
-                    txn.exec_params("UPDATE tracked_repos SET last_commit_sha = $1 WHERE repo_name = $2;", new_commit_sha, repo);
-                    spdlog::info("Updated last commit for {} to {}", repo, new_commit_sha);
+                if (!new_commits.empty()) {
+                    batch.checkpoint(repo, commits.front().sha);
                 }
-                txn.commit();
+                polled.push_back(PolledRepo{&repo, mode, url, cache_entry(response, body_digest)});
             } else {
                 spdlog::error("Failed to fetch commits for {}. HTTP Status: {}", repo, response.status_code);
+                note_poll(repo, mode, false);
             }
 
         } catch (const std::exception& e) {
             spdlog::error("Error processing commits for {}: {}", repo, e.what());
+            note_poll(repo, mode, false);
+        }
+    }
+
+    // ✅ Responses are only remembered once their commits are stored; otherwise the next
+    // cycle would get a 304 and the checkpoint would never move
+    bool stored = batch.flush();
+    for (const PolledRepo& entry : polled) {
+        note_poll(*entry.repo, entry.mode, batch.announced(*entry.repo) > 0);
+        if (stored) {
+            http_cache().store(entry.url, entry.validators);
         }
     }
 }
 
+static std::string lowercase(std::string_view text) {
+    std::string lower(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower;
+}
+
+// ✅ Tracked repo names by lower-cased name, kept while the cache listener is up
+using TrackedNames = std::unordered_map<std::string, std::string>;
+static InvalidatedCache<TrackedNames> tracked_repo_cache;
+
+void invalidate_tracked_repo_cache() {
+    tracked_repo_cache.invalidate();
+}
+
+static TrackedNames load_tracked_names() {
+    auto conn = db_pool().acquire();
+    pqxx::work txn(*conn);
+    TrackedNames names;
+    for (const auto& row : txn.exec_prepared(conn.prepared(Statement::TrackedRepos))) {
+        std::string name = row[0].as<std::string>();
+        names.emplace(lowercase(name), name);
+    }
+    return names;
+}
+
+// ✅ Tracked name of a repo given in any case (GitHub reports the canonical case; match
+// it against what the admin typed), or "" if it is not tracked
+static std::string find_tracked_repo(std::string_view repo) {
+    auto names = tracked_repo_cache.get(load_tracked_names);
+    auto it = names->find(lowercase(repo));
+    return it == names->end() ? std::string() : it->second;
+}
+
+// ✅ Handle a batch of commits from a `push` webhook delivery: same store/announce path
+// as the poller. Large pushes arrive as several batches, in order. Returns false only
+// when the commits could not be stored, so the spooled delivery is kept for a retry.
+bool handle_push_event(PushBatch& batch) {
+    if (!batch.parsed) {
+        spdlog::error("❌ Malformed push event payload");
+        return true;  // nothing a retry would fix
+    }
+    const PushEvent& event = batch.event;
+    const CommitList& commits = batch.commits;
+    std::pmr::memory_resource* arena = &batch.arena;
+
+    // ✅ Any delivery proves the hook works, even for branches we don't announce
+    if (!event.repo.empty()) {
+        note_webhook_delivery(event.repo);
+    }
+
+    // ✅ Like the poller, only the default branch is announced
+    std::string branch_ref = "refs/heads/" + std::string(event.default_branch);
+    if (event.repo.empty() || event.ref != branch_ref) {
+        spdlog::debug("Ignoring push to {} {}", event.repo, event.ref);
+        return true;
+    }
+    if (commits.empty()) {
+        return true;
+    }
+
+    try {
+        std::string repo = find_tracked_repo(event.repo);
+        if (repo.empty()) {
+            spdlog::debug("Ignoring push for untracked repo {}", event.repo);
+            return true;
+        }
+
+        spdlog::info("📬 Push webhook for {}: {} commit(s)", repo, commits.size());
+        CommitBatch writer(arena);
+        writer.add(repo, commits);
+        writer.checkpoint(repo, commits.back().sha);
+        return writer.flush();
+    } catch (const std::exception& e) {
+        spdlog::error("Error processing push event for {}: {}", event.repo, e.what());
+        return false;
+    }
+}
+
+// ✅ Commits reported over the local ingest socket. Unlike pushes they may come from any
+// branch, so last_commit_sha is left to the poller; dedup keeps it from re-announcing them.
+bool handle_local_commits(std::string_view repo, const CommitList& commits, std::pmr::memory_resource* arena) {
+    try {
+        std::string tracked = find_tracked_repo(repo);
+        if (tracked.empty()) {
+            spdlog::debug("Ignoring local commit events for untracked repo {}", repo);
+            return true;
+        }
+
+        CommitBatch writer(arena);
+        writer.add(tracked, commits);
+        return writer.flush();
+    } catch (const std::exception& e) {
+        spdlog::error("Error processing local commit events for {}: {}", repo, e.what());
+        return false;
+    }
+}
+
 // ✅ Fetch the latest commit live from GitHub API
 std::string get_last_commit(const std::string& repo) {
     std::string url = "https://api.github.com/repos/" + repo + "/commits?page=1&per_page=1";
 
     cpr::Header headers = {{"User-Agent", "C++-GitHub-Bot"}};
-    if (!GITHUB_API_KEY.empty()) {
-        headers["Authorization"] = "token " + GITHUB_API_KEY;
+    std::string api_key = config()->github_api_key;
+    if (!api_key.empty()) {
+        headers["Authorization"] = "token " + api_key;
     }
 
     auto response = cpr::Get(cpr::Url{url}, headers);
 
     if (response.status_code == 200) {
         try {
-            json commits = json::parse(response.text);
+            std::pmr::monotonic_buffer_resource arena;
+            CommitList commits(&arena);
+            if (!parse_commits(response.text, commits)) {
+                return "❌ Error retrieving last commit.";
+            }
 
             if (!commits.empty()) {
-                std::string sha = commits[0]["sha"];
-                std::string author = commits[0]["commit"]["author"]["name"];
-                std::string message = commits[0]["commit"]["message"];
-                std::string commit_url = "https://github.com/" + repo + "/commit/" + sha;
-
-                std::string irc_message = "[" + repo + "] " + author + " " + sha.substr(0, 7) +
-                                           " - " + message + " (" + commit_url + ")";
-                return irc_message;
+                return std::string(render_commit_line(repo, commits[0], &arena));
             } else {
                 return "⚠️ No commits found for " + repo;
             }
@@ -0,0 +1,891 @@
+#include "github_parser.h"
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#ifdef BOTHUB_SIMDJSON
+#include <simdjson.h>
+#endif
+
+using json = nlohmann::json;
+
+// ✅ Copy an unescaped value into the arena (the one copy a non-trivial string costs)
+std::string_view copy_to_arena(std::string_view value, std::pmr::memory_resource* arena) {
+    if (value.empty()) {
+        return {};
+    }
+    char* data = static_cast<char*>(arena->allocate(value.size(), 1));
+    std::memcpy(data, value.data(), value.size());
+    return {data, value.size()};
+}
+
+namespace {
+
+// Keys that matter on the way down to a commit field; everything else is Other.
+enum class Key : unsigned char {
+    None, Other, Sha, Id, Commit, Commits, Author, Name, Message, Date, Timestamp,
+    Ref, Repository, FullName, DefaultBranch
+};
+
+Key classify(const std::string& key) {
+    switch (key.size()) {
+        case 2: return key == "id" ? Key::Id : Key::Other;
+        case 3: return key == "sha" ? Key::Sha : key == "ref" ? Key::Ref : Key::Other;
+        case 4: return key == "name" ? Key::Name : key == "date" ? Key::Date : Key::Other;
+        case 6: return key == "commit" ? Key::Commit : key == "author" ? Key::Author : Key::Other;
+        case 7: return key == "commits" ? Key::Commits : key == "message" ? Key::Message : Key::Other;
+        case 9: return key == "timestamp" ? Key::Timestamp : key == "full_name" ? Key::FullName : Key::Other;
+        case 10: return key == "repository" ? Key::Repository : Key::Other;
+        case 14: return key == "default_branch" ? Key::DefaultBranch : Key::Other;
+        default: return Key::Other;
+    }
+}
+
+// Input iterator over the payload that publishes how far the lexer has read, so the
+// SAX handler can find the raw bytes of each string value it is handed.
+class TrackedIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = char;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const char*;
+    using reference = const char&;
+
+    TrackedIterator(const char* position, const char** cursor) : position(position), cursor(cursor) {}
+
+    reference operator*() const { return *position; }
+    TrackedIterator& operator++() {
+        *cursor = ++position;
+        return *this;
+    }
+    bool operator==(const TrackedIterator& other) const { return position == other.position; }
+    bool operator!=(const TrackedIterator& other) const { return position != other.position; }
+
+private:
+    const char* position;
+    const char** cursor;
+};
+
+// ✅ SAX handler that walks the payload with a fixed-size path stack and keeps only
+// sha / author / message / timestamp. Values on any other path are dropped as soon
+// as the lexer hands them over; kept values are views into the payload whenever
+// their raw bytes need no unescaping.
+//
+// Recognised layouts:
+//   REST list:   [ { "sha", "commit": { "message", "author": { "name", "date" } } } ]
+//   compare/push { "commits": [ { "sha"|"id", "message", "timestamp", "author": { "name" } } ] }
+class CommitSaxHandler : public nlohmann::json_sax<json> {
+public:
+    CommitSaxHandler(CommitList& out, PushEvent* push_event, const char* payload_start, const char* const& read_cursor)
+        : commits(out), event(push_event), start(payload_start), cursor(read_cursor), arena(out.get_allocator().resource()) {}
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t) override { return true; }
+    bool number_unsigned(number_unsigned_t) override { return true; }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& value) override {
+        if (std::string_view* field = current_field()) {
+            *field = keep(value);
+        }
+        return true;
+    }
+
+    bool key(string_t& value) override {
+        if (depth > 0 && depth <= MAX_DEPTH) {
+            levels[depth - 1].current_key = classify(value);
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        push(false);
+        if (depth == commit_depth() && depth <= MAX_DEPTH) {
+            commits.emplace_back();
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        --depth;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        push(true);
+        return true;
+    }
+
+    bool end_array() override {
+        --depth;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override {
+        spdlog::error("❌ GitHub payload parse error at byte {}: {}", position, ex.what());
+        return false;
+    }
+
+private:
+    static constexpr std::size_t MAX_DEPTH = 8;
+
+    struct Level {
+        bool is_array = false;
+        Key opened_by = Key::None;
+        Key current_key = Key::None;
+    };
+
+    void push(bool is_array) {
+        if (depth < MAX_DEPTH) {
+            Key opened_by = depth == 0 ? Key::None
+                          : levels[depth - 1].is_array ? Key::None
+                          : levels[depth - 1].current_key;
+            levels[depth] = Level{is_array, opened_by, Key::None};
+        }
+        ++depth;
+    }
+
+    // Depth (1-based) at which commit objects live: inside a root array, or inside
+    // the `commits` array of a root object. Zero if the root is neither.
+    std::size_t commit_depth() const {
+        if (depth == 0) {
+            return 0;
+        }
+        if (levels[0].is_array) {
+            return 2;
+        }
+        if (depth >= 2 && levels[1].is_array && levels[1].opened_by == Key::Commits) {
+            return 3;
+        }
+        return 0;
+    }
+
+    // The lexer has just consumed the closing quote. If the bytes before it are the
+    // value itself (no escapes), point at them; otherwise copy the unescaped text.
+    std::string_view keep(const std::string& value) const {
+        std::size_t size = value.size();
+        const char* end = cursor - 1;
+        if (static_cast<std::size_t>(end - start) >= size + 1 && *end == '"' &&
+            end[-static_cast<std::ptrdiff_t>(size) - 1] == '"' &&
+            std::memcmp(end - size, value.data(), size) == 0) {
+            return {end - size, size};
+        }
+        return copy_to_arena(value, arena);
+    }
+
+    // Push routing fields: root `ref` and `repository.{full_name,default_branch}`
+    std::string_view* event_field() {
+        if (!event || levels[0].is_array) {
+            return nullptr;
+        }
+        if (depth == 1 && levels[0].current_key == Key::Ref) {
+            return &event->ref;
+        }
+        if (depth == 2 && levels[1].opened_by == Key::Repository) {
+            if (levels[1].current_key == Key::FullName) {
+                return &event->repo;
+            }
+            if (levels[1].current_key == Key::DefaultBranch) {
+                return &event->default_branch;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string_view* current_field() {
+        if (std::string_view* field = event_field()) {
+            return field;
+        }
+
+        std::size_t base = commit_depth();
+        if (base == 0 || depth < base || depth > MAX_DEPTH || commits.empty()) {
+            return nullptr;
+        }
+
+        const Level& level = levels[depth - 1];
+        if (level.is_array) {
+            return nullptr;
+        }
+
+        CommitRecord& record = commits.back();
+        std::size_t nested = depth - base;
+
+        if (nested == 0) {
+            switch (level.current_key) {
+                case Key::Sha:
+                case Key::Id: return &record.sha;
+                case Key::Message: return &record.message;
+                case Key::Timestamp: return &record.timestamp;
+                default: return nullptr;
+            }
+        }
+        if (nested == 1 && level.opened_by == Key::Commit && level.current_key == Key::Message) {
+            return &record.message;
+        }
+        if (nested == 1 && level.opened_by == Key::Author && level.current_key == Key::Name) {
+            return &record.author;
+        }
+        if (nested == 2 && level.opened_by == Key::Author && levels[base].opened_by == Key::Commit) {
+            if (level.current_key == Key::Name) {
+                return &record.author;
+            }
+            if (level.current_key == Key::Date) {
+                return &record.timestamp;
+            }
+        }
+        return nullptr;
+    }
+
+    CommitList& commits;
+    PushEvent* event;
+    const char* start;
+    const char* const& cursor;
+    std::pmr::memory_resource* arena;
+    std::array<Level, MAX_DEPTH> levels{};
+    std::size_t depth = 0;
+};
+
+}  // namespace
+
+static bool sax_parse_payload(const std::string& payload, CommitList& commits, PushEvent* event) {
+    commits.clear();
+    const char* cursor = payload.data();
+    CommitSaxHandler handler(commits, event, payload.data(), cursor);
+    TrackedIterator first(payload.data(), &cursor);
+    TrackedIterator last(payload.data() + payload.size(), &cursor);
+    return json::sax_parse(first, last, &handler);
+}
+
+bool parse_commits_nlohmann(const std::string& payload, CommitList& commits) {
+    return sax_parse_payload(payload, commits, nullptr);
+}
+
+#ifdef BOTHUB_SIMDJSON
+
+namespace {
+
+using simdjson::ondemand::json_type;
+
+// ✅ View of a string value: the raw bytes in the input buffer when they contain no
+// escapes, otherwise an arena copy of the unescaped text
+void read_string(simdjson::ondemand::value value, std::string_view& out, std::pmr::memory_resource* arena) {
+    std::string_view token = value.raw_json_token();
+    if (token.empty() || token.front() != '"') {
+        return;
+    }
+    std::string_view raw = token.substr(1, token.find_last_of('"') - 1);
+    if (raw.find('\\') == std::string_view::npos) {
+        out = raw;
+    } else {
+        out = copy_to_arena(std::string_view(value.get_string()), arena);
+    }
+}
+
+// ✅ Fields of `commit.author` (REST) or `author` (push events)
+void read_author(simdjson::ondemand::value value, CommitRecord& record, std::pmr::memory_resource* arena) {
+    if (value.type() != json_type::object) {
+        return;
+    }
+    for (auto field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        if (key == "name") {
+            read_string(field.value(), record.author, arena);
+        } else if (key == "date") {
+            read_string(field.value(), record.timestamp, arena);
+        }
+    }
+}
+
+// ✅ The nested `commit` object of a REST commit
+void read_git_commit(simdjson::ondemand::value value, CommitRecord& record, std::pmr::memory_resource* arena) {
+    if (value.type() != json_type::object) {
+        return;
+    }
+    for (auto field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        if (key == "message") {
+            read_string(field.value(), record.message, arena);
+        } else if (key == "author") {
+            read_author(field.value(), record, arena);
+        }
+    }
+}
+
+void read_commit(simdjson::ondemand::value value, CommitList& commits) {
+    if (value.type() != json_type::object) {
+        return;
+    }
+    std::pmr::memory_resource* arena = commits.get_allocator().resource();
+    CommitRecord& record = commits.emplace_back();
+    for (auto field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        if (key == "sha" || key == "id") {
+            read_string(field.value(), record.sha, arena);
+        } else if (key == "message") {
+            read_string(field.value(), record.message, arena);
+        } else if (key == "timestamp") {
+            read_string(field.value(), record.timestamp, arena);
+        } else if (key == "commit") {
+            read_git_commit(field.value(), record, arena);
+        } else if (key == "author") {
+            // REST puts the GitHub user here (no `name`), push events the git author
+            simdjson::ondemand::value author = field.value();
+            if (author.type() == json_type::object) {
+                std::string_view name;
+                for (auto author_field : author.get_object()) {
+                    if (std::string_view(author_field.unescaped_key()) == "name") {
+                        read_string(author_field.value(), name, arena);
+                    }
+                }
+                if (!name.empty()) {
+                    record.author = name;
+                }
+            }
+        }
+    }
+}
+
+void read_commit_array(simdjson::ondemand::array array, CommitList& commits) {
+    for (simdjson::ondemand::value value : array) {
+        read_commit(value, commits);
+    }
+}
+
+// ✅ `repository.full_name` / `repository.default_branch` of a push event
+void read_repository(simdjson::ondemand::value value, PushEvent& event, std::pmr::memory_resource* arena) {
+    if (value.type() != json_type::object) {
+        return;
+    }
+    for (auto field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        if (key == "full_name") {
+            read_string(field.value(), event.repo, arena);
+        } else if (key == "default_branch") {
+            read_string(field.value(), event.default_branch, arena);
+        }
+    }
+}
+
+bool simdjson_parse_payload(const std::string& payload, CommitList& commits, PushEvent* event) {
+    commits.clear();
+    thread_local simdjson::ondemand::parser parser;
+
+    try {
+        // Parse in place when the string already has room for simdjson's padding;
+        // otherwise the padded copy lives in the arena so record views stay valid
+        simdjson::padded_string_view input;
+        if (payload.capacity() >= payload.size() + simdjson::SIMDJSON_PADDING) {
+            input = simdjson::padded_string_view(payload.data(), payload.size(), payload.capacity());
+        } else {
+            std::size_t capacity = payload.size() + simdjson::SIMDJSON_PADDING;
+            char* copy = static_cast<char*>(commits.get_allocator().resource()->allocate(capacity, 1));
+            std::memcpy(copy, payload.data(), payload.size());
+            std::memset(copy + payload.size(), 0, simdjson::SIMDJSON_PADDING);
+            input = simdjson::padded_string_view(copy, payload.size(), capacity);
+        }
+
+        simdjson::ondemand::document doc = parser.iterate(input);
+        json_type root_type = doc.type();
+        if (root_type == json_type::array) {
+            read_commit_array(doc.get_array(), commits);
+        } else if (root_type == json_type::object) {
+            std::pmr::memory_resource* arena = commits.get_allocator().resource();
+            for (auto field : doc.get_object()) {
+                std::string_view key = field.unescaped_key();
+                if (key == "commits") {
+                    simdjson::ondemand::value value = field.value();
+                    if (value.type() == json_type::array) {
+                        read_commit_array(value.get_array(), commits);
+                    }
+                } else if (event && key == "ref") {
+                    read_string(field.value(), event->ref, arena);
+                } else if (event && key == "repository") {
+                    read_repository(field.value(), *event, arena);
+                }
+            }
+        }
+        return true;
+    } catch (const simdjson::simdjson_error& e) {
+        spdlog::error("❌ GitHub payload parse error: {}", e.what());
+        commits.clear();
+        return false;
+    }
+}
+
+}  // namespace
+
+bool parse_commits_simdjson(const std::string& payload, CommitList& commits) {
+    return simdjson_parse_payload(payload, commits, nullptr);
+}
+
+#endif  // BOTHUB_SIMDJSON
+
+bool parse_commits(const std::string& payload, CommitList& commits) {
+#ifdef BOTHUB_SIMDJSON
+    return simdjson_parse_payload(payload, commits, nullptr);
+#else
+    return sax_parse_payload(payload, commits, nullptr);
+#endif
+}
+
+bool parse_push_event(const std::string& payload, PushEvent& event, CommitList& commits) {
+    event = PushEvent{};
+#ifdef BOTHUB_SIMDJSON
+    return simdjson_parse_payload(payload, commits, &event);
+#else
+    return sax_parse_payload(payload, commits, &event);
+#endif
+}
+
+void PushBatch::add(const CommitRecord& commit) {
+    commits.push_back(CommitRecord{copy_to_arena(commit.sha, &arena), copy_to_arena(commit.author, &arena),
+                                   copy_to_arena(commit.message, &arena), copy_to_arena(commit.timestamp, &arena)});
+}
+
+void PushBatch::route(const PushEvent& routing) {
+    event = PushEvent{copy_to_arena(routing.ref, &arena), copy_to_arena(routing.repo, &arena),
+                      copy_to_arena(routing.default_branch, &arena)};
+}
+
+// ✅ PushStreamParser: a byte-at-a-time JSON state machine that keeps only the path
+// (same Key/Level bookkeeping as CommitSaxHandler) and the fields being captured.
+struct PushStreamParser::State {
+    enum class Lex : unsigned char { Structure, String, Escape, Unicode, Literal, Failed };
+    // What the grammar allows next (outside strings and literals)
+    enum class Expect : unsigned char { Value, ValueOrClose, Key, KeyOrClose, Colon, CommaOrClose, End };
+
+    static constexpr std::size_t MAX_DEPTH = 8;     // path tracked this deep
+    static constexpr std::size_t MAX_NESTING = 512; // deeper documents are rejected
+    static constexpr std::size_t MAX_KEY_BYTES = 32;
+    static constexpr std::size_t MAX_LITERAL_BYTES = 64;
+
+    struct Level {
+        bool is_array = false;
+        Key opened_by = Key::None;
+        Key current_key = Key::None;
+    };
+
+    std::function<void(const CommitRecord&)> on_commit;
+    Lex lex = Lex::Structure;
+    std::vector<bool> containers;  // true = array, one entry per open container
+    std::array<Level, MAX_DEPTH> levels{};
+    Expect expect = Expect::Value;
+    std::string literal;  // true / false / null / number being read
+
+    // String being read: key, captured value or skipped value
+    bool string_is_key = false;
+    std::string* target = nullptr;
+    std::size_t target_cap = 0;
+    std::string key;
+    unsigned unicode_digits = 0;
+    uint32_t unicode_unit = 0;
+    uint32_t high_surrogate = 0;
+
+    std::string sha, author, message, timestamp;
+    std::string ref, repo, default_branch;
+
+    std::size_t depth() const { return containers.size(); }
+
+    std::size_t commit_depth() const {
+        if (depth() == 0) {
+            return 0;
+        }
+        if (levels[0].is_array) {
+            return 2;
+        }
+        if (depth() >= 2 && levels[1].is_array && levels[1].opened_by == Key::Commits) {
+            return 3;
+        }
+        return 0;
+    }
+
+    std::string* event_field() {
+        if (levels[0].is_array) {
+            return nullptr;
+        }
+        if (depth() == 1 && levels[0].current_key == Key::Ref) {
+            return &ref;
+        }
+        if (depth() == 2 && levels[1].opened_by == Key::Repository) {
+            if (levels[1].current_key == Key::FullName) {
+                return &repo;
+            }
+            if (levels[1].current_key == Key::DefaultBranch) {
+                return &default_branch;
+            }
+        }
+        return nullptr;
+    }
+
+    // Mirrors CommitSaxHandler::current_field()
+    std::string* commit_field() {
+        std::size_t base = commit_depth();
+        if (base == 0 || depth() < base || depth() > MAX_DEPTH) {
+            return nullptr;
+        }
+        const Level& level = levels[depth() - 1];
+        if (level.is_array) {
+            return nullptr;
+        }
+
+        std::size_t nested = depth() - base;
+        if (nested == 0) {
+            switch (level.current_key) {
+                case Key::Sha:
+                case Key::Id: return &sha;
+                case Key::Message: return &message;
+                case Key::Timestamp: return &timestamp;
+                default: return nullptr;
+            }
+        }
+        if (nested == 1 && level.opened_by == Key::Commit && level.current_key == Key::Message) {
+            return &message;
+        }
+        if (nested == 1 && level.opened_by == Key::Author && level.current_key == Key::Name) {
+            return &author;
+        }
+        if (nested == 2 && level.opened_by == Key::Author && levels[base].opened_by == Key::Commit) {
+            if (level.current_key == Key::Name) {
+                return &author;
+            }
+            if (level.current_key == Key::Date) {
+                return &timestamp;
+            }
+        }
+        return nullptr;
+    }
+
+    bool open(bool is_array) {
+        if (depth() >= MAX_NESTING || (expect != Expect::Value && expect != Expect::ValueOrClose)) {
+            return false;
+        }
+        if (depth() < MAX_DEPTH) {
+            Key opened_by = depth() == 0 ? Key::None
+                          : levels[depth() - 1].is_array ? Key::None
+                          : levels[depth() - 1].current_key;
+            levels[depth()] = Level{is_array, opened_by, Key::None};
+        }
+        containers.push_back(is_array);
+        expect = is_array ? Expect::ValueOrClose : Expect::KeyOrClose;
+
+        if (depth() == commit_depth() && depth() <= MAX_DEPTH && !is_array) {
+            sha.clear();
+            author.clear();
+            message.clear();
+            timestamp.clear();
+        }
+        return true;
+    }
+
+    bool close(bool is_array) {
+        Expect allowed = is_array ? Expect::ValueOrClose : Expect::KeyOrClose;
+        if (containers.empty() || containers.back() != is_array ||
+            (expect != allowed && expect != Expect::CommaOrClose)) {
+            return false;
+        }
+        if (!is_array && depth() == commit_depth() && depth() <= MAX_DEPTH && !sha.empty()) {
+            on_commit(CommitRecord{sha, author, message, timestamp});
+        }
+        containers.pop_back();
+        value_done();
+        return true;
+    }
+
+    void value_done() {
+        expect = containers.empty() ? Expect::End : Expect::CommaOrClose;
+    }
+
+    void begin_string() {
+        string_is_key = expect == Expect::Key || expect == Expect::KeyOrClose;
+        if (string_is_key) {
+            key.clear();
+            target = &key;
+            target_cap = MAX_KEY_BYTES;
+            return;
+        }
+
+        target = event_field();
+        if (!target) {
+            target = commit_field();
+        }
+        target_cap = target == &message ? std::string::npos : PushStreamParser::MAX_FIELD_BYTES;
+        if (target) {
+            target->clear();
+        }
+    }
+
+    void put(char c) {
+        if (target && target->size() < target_cap) {
+            target->push_back(c);
+        }
+    }
+
+    void put_code_point(uint32_t cp) {
+        if (cp < 0x80) {
+            put(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            put(static_cast<char>(0xC0 | (cp >> 6)));
+            put(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            put(static_cast<char>(0xE0 | (cp >> 12)));
+            put(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            put(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            put(static_cast<char>(0xF0 | (cp >> 18)));
+            put(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            put(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            put(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    void flush_surrogate() {
+        if (high_surrogate) {
+            put_code_point(0xFFFD);
+            high_surrogate = 0;
+        }
+    }
+
+    void unicode_unit_done() {
+        uint32_t unit = unicode_unit;
+        if (unit >= 0xD800 && unit <= 0xDBFF) {
+            flush_surrogate();
+            high_surrogate = unit;
+        } else if (unit >= 0xDC00 && unit <= 0xDFFF) {
+            if (high_surrogate) {
+                put_code_point(0x10000 + ((high_surrogate - 0xD800) << 10) + (unit - 0xDC00));
+                high_surrogate = 0;
+            } else {
+                put_code_point(0xFFFD);
+            }
+        } else {
+            flush_surrogate();
+            put_code_point(unit);
+        }
+    }
+
+    // Don't leave half a UTF-8 sequence behind where a value was capped
+    static void trim_partial_utf8(std::string& value) {
+        std::size_t end = value.size();
+        std::size_t lead = end;
+        while (lead > 0 && (static_cast<unsigned char>(value[lead - 1]) & 0xC0) == 0x80) {
+            --lead;
+        }
+        if (lead == 0) {
+            return;
+        }
+        unsigned char byte = static_cast<unsigned char>(value[lead - 1]);
+        std::size_t expected = byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+        if (end - (lead - 1) < expected) {
+            value.resize(lead - 1);
+        }
+    }
+
+    void end_string() {
+        flush_surrogate();
+        if (string_is_key) {
+            if (depth() > 0 && depth() <= MAX_DEPTH) {
+                levels[depth() - 1].current_key = key.size() < MAX_KEY_BYTES ? classify(key) : Key::Other;
+            }
+        } else if (target && target->size() >= target_cap) {
+            trim_partial_utf8(*target);
+        }
+        target = nullptr;
+        if (string_is_key) {
+            expect = Expect::Colon;
+        } else {
+            value_done();
+        }
+    }
+
+    // Exactly true / false / null or a JSON number: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    static bool valid_literal(const std::string& text) {
+        if (text == "true" || text == "false" || text == "null") {
+            return true;
+        }
+        std::size_t i = 0;
+        auto digits = [&]() {
+            std::size_t start = i;
+            while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+                ++i;
+            }
+            return i > start;
+        };
+        if (i < text.size() && text[i] == '-') {
+            ++i;
+        }
+        if (i < text.size() && text[i] == '0') {
+            ++i;
+        } else if (!digits()) {
+            return false;
+        }
+        if (i < text.size() && text[i] == '.') {
+            ++i;
+            if (!digits()) {
+                return false;
+            }
+        }
+        if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+            ++i;
+            if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+                ++i;
+            }
+            if (!digits()) {
+                return false;
+            }
+        }
+        return i == text.size();
+    }
+
+    bool end_literal() {
+        lex = Lex::Structure;
+        if (!valid_literal(literal)) {
+            return false;
+        }
+        value_done();
+        return true;
+    }
+
+    bool structure(char c) {
+        switch (c) {
+            case ' ': case '\t': case '\n': case '\r': return true;
+            case '{': return open(false);
+            case '[': return open(true);
+            case '}': return close(false);
+            case ']': return close(true);
+            case ':':
+                if (expect != Expect::Colon) {
+                    return false;
+                }
+                expect = Expect::Value;
+                return true;
+            case ',':
+                if (expect != Expect::CommaOrClose) {
+                    return false;
+                }
+                expect = containers.back() ? Expect::Value : Expect::Key;
+                return true;
+            case '"':
+                if (expect == Expect::Colon || expect == Expect::CommaOrClose || expect == Expect::End) {
+                    return false;
+                }
+                begin_string();
+                lex = Lex::String;
+                return true;
+            default:
+                if ((c >= '0' && c <= '9') || c == '-' || c == 't' || c == 'f' || c == 'n') {
+                    if (expect != Expect::Value && expect != Expect::ValueOrClose) {
+                        return false;
+                    }
+                    literal.assign(1, c);
+                    lex = Lex::Literal;
+                    return true;
+                }
+                return false;
+        }
+    }
+
+    bool feed(std::string_view chunk) {
+        for (char c : chunk) {
+            switch (lex) {
+                case Lex::Failed:
+                    return false;
+                case Lex::Literal:
+                    if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '.' || c == '+' || c == '-' || c == 'E') {
+                        if (literal.size() >= MAX_LITERAL_BYTES) {
+                            lex = Lex::Failed;
+                            return false;
+                        }
+                        literal.push_back(c);
+                        continue;
+                    }
+                    if (!end_literal()) {
+                        lex = Lex::Failed;
+                        return false;
+                    }
+                    [[fallthrough]];
+                case Lex::Structure:
+                    if (!structure(c)) {
+                        lex = Lex::Failed;
+                        return false;
+                    }
+                    break;
+                case Lex::String:
+                    if (c == '"') {
+                        end_string();
+                        lex = Lex::Structure;
+                    } else if (c == '\\') {
+                        lex = Lex::Escape;
+                    } else if (static_cast<unsigned char>(c) < 0x20) {
+                        lex = Lex::Failed;  // control characters must be escaped
+                        return false;
+                    } else {
+                        flush_surrogate();
+                        put(c);
+                    }
+                    break;
+                case Lex::Escape:
+                    lex = Lex::String;
+                    switch (c) {
+                        case 'n': flush_surrogate(); put('\n'); break;
+                        case 't': flush_surrogate(); put('\t'); break;
+                        case 'r': flush_surrogate(); put('\r'); break;
+                        case 'b': flush_surrogate(); put('\b'); break;
+                        case 'f': flush_surrogate(); put('\f'); break;
+                        case '"': case '\\': case '/': flush_surrogate(); put(c); break;
+                        case 'u':
+                            unicode_digits = 0;
+                            unicode_unit = 0;
+                            lex = Lex::Unicode;
+                            break;
+                        default:
+                            lex = Lex::Failed;
+                            return false;
+                    }
+                    break;
+                case Lex::Unicode: {
+                    int digit = c >= '0' && c <= '9' ? c - '0'
+                              : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                              : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+                    if (digit < 0) {
+                        lex = Lex::Failed;
+                        return false;
+                    }
+                    unicode_unit = (unicode_unit << 4) | static_cast<uint32_t>(digit);
+                    if (++unicode_digits == 4) {
+                        unicode_unit_done();
+                        lex = Lex::String;
+                    }
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+PushStreamParser::PushStreamParser(std::function<void(const CommitRecord&)> on_commit)
+    : state(std::make_unique<State>()) {
+    state->on_commit = std::move(on_commit);
+}
+
+PushStreamParser::~PushStreamParser() = default;
+
+bool PushStreamParser::feed(std::string_view chunk) {
+    return state->feed(chunk);
+}
+
+bool PushStreamParser::finish() {
+    if (state->lex == State::Lex::Literal && !state->end_literal()) {
+        state->lex = State::Lex::Failed;
+    }
+    return state->lex == State::Lex::Structure && state->expect == State::Expect::End;
+}
+
+PushEvent PushStreamParser::event() const {
+    return PushEvent{state->ref, state->repo, state->default_branch};
+}
@@ -1,13 +1,32 @@
 #include "irc_api.h"
 #include "config.h"
 #include "common.h"
+#include "db_executor.h"
 #include <spdlog/spdlog.h>
 #include <QCoreApplication>
 #include <QTimer>
 #include <QByteArray>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 
 IRCClient* global_irc_client = nullptr;  // ✅ Define global pointer
 
+static const size_t SEARCH_PAGE_SIZE = 5;
+static const int STATS_DEFAULT_DAYS = 30;
+static const int STATS_MAX_DAYS = 3650;
+static const size_t TOP_COMMITTERS = 5;
+
+// ✅ Announcements wait here until the channels are joined (startup replay of spooled
+// webhooks, deliveries during a reconnect) and then go out in order
+static const size_t OUTBOUND_BACKLOG = 1000;
+static std::deque<std::string> outbound;
+static bool channels_joined = false;
+static std::mutex outbound_mutex;  // guards both
+
+// ✅ Where `!git more` continues, per "target nick"; only touched on the IRC thread
+static std::unordered_map<std::string, SearchQuery> search_sessions;
+
 // ✅ Constructor: Initialize `IrcConnection`
 IRCClient::IRCClient(QObject* parent) : QObject(parent) {
     connection = new IrcConnection(this);
@@ -104,34 +123,78 @@ void IRCClient::joinChannels() {
         connection->sendCommand(IrcCommand::createJoin(channel));
     }
 
+    {
+        std::lock_guard<std::mutex> lock(outbound_mutex);
+        channels_joined = true;
+    }
+    flushOutbound();
+
     spdlog::info("✅ Starting commit checker after joining channels...");
     QTimer::singleShot(5000, start_commit_checker);
 }
 
-void IRCClient::sendIrcMessage(const std::string& message) {
+void IRCClient::sendIrcMessage(std::string_view message) {
     if (!connection) {
         spdlog::error("❌ IRC Connection is NULL. Cannot send message.");
         return;
     }
 
+    QString text = QString::fromUtf8(message.data(), static_cast<int>(message.size()));
     QStringList channelList = QString::fromStdString(CHANNELS).split(",", Qt::SkipEmptyParts);
     for (const QString& channel : channelList) {
         spdlog::info("📢 Sending message to IRC: {}", message);
-        connection->sendCommand(IrcCommand::createMessage(channel, QString::fromStdString(message)));
+        connection->sendCommand(IrcCommand::createMessage(channel, text));
+    }
+}
+// ✅ Send everything queued, oldest first; runs on the IRC client's thread
+void IRCClient::flushOutbound() {
+    std::deque<std::string> lines;
+    {
+        std::lock_guard<std::mutex> lock(outbound_mutex);
+        if (!channels_joined) {
+            return;
+        }
+        lines.swap(outbound);
+    }
+    for (const std::string& line : lines) {
+        sendIrcMessage(line);
     }
 }
-void send_irc_message(const std::string& message) {
-    spdlog::info("📢 Sending message to IRC: {}", message);
-    if (global_irc_client) {
-        global_irc_client->sendIrcMessage(message);
-    } else {
-        spdlog::error("❌ IRCClient not initialized. Cannot send message.");
+
+// ✅ Safe from any thread: the line is queued and sent from the IRC client's thread once
+// the channels are joined
+void send_irc_message(std::string_view message) {
+    spdlog::info("📢 Queueing message for IRC: {}", message);
+    bool post = false;
+    {
+        std::lock_guard<std::mutex> lock(outbound_mutex);
+        if (outbound.size() >= OUTBOUND_BACKLOG) {
+            spdlog::warn("⚠️ IRC backlog full, dropping: {}", outbound.front());
+            outbound.pop_front();
+        }
+        outbound.emplace_back(message);
+        // A non-empty queue already has a flush on its way (or waits for the join)
+        post = channels_joined && outbound.size() == 1 && global_irc_client;
+    }
+    if (post) {
+        QMetaObject::invokeMethod(global_irc_client, []() {
+            global_irc_client->flushOutbound();
+        }, Qt::QueuedConnection);
     }
 }
 
+// ✅ Send a command's reply; used as the completion of database work
+void IRCClient::reply(const QString& target, const std::string& response) {
+    connection->sendCommand(IrcCommand::createMessage(target, QString::fromStdString(response)));
+}
+
 // ✅ Handle disconnection
 void IRCClient::onDisconnected() {
     spdlog::error("Disconnected from IRC server.");
+    {
+        std::lock_guard<std::mutex> lock(outbound_mutex);
+        channels_joined = false;  // hold announcements until the next join
+    }
     emit disconnected();
 }
 
@@ -151,50 +214,143 @@ void IRCClient::onPrivateMessageReceived(IrcPrivateMessage* message) {
     std::string sender_hostmask = nick.toStdString() + "!" + host.toStdString();
     spdlog::info("📩 Private message from {}: {}", sender_hostmask, content.toStdString());
 
+    // ✅ Every command touches Postgres (or GitHub): run it on the database executor
+    // and send the reply when it completes, so the IRC thread never waits
     if (content.startsWith("!admin add ")) {
         std::string new_admin_hostmask = content.mid(11).toStdString();
-        std::string response = add_admin(sender_hostmask, new_admin_hostmask);
-        connection->sendCommand(IrcCommand::createMessage(target_channel, QString::fromStdString(response)));
+        db_executor().submit(this, [sender_hostmask, new_admin_hostmask]() {
+            return add_admin(sender_hostmask, new_admin_hostmask);
+        }, [this, target_channel](const std::string& response) { reply(target_channel, response); });
     }
     else if (content.startsWith("!admin del ")) {
         std::string target_hostmask = content.mid(11).toStdString();
-        std::string response = remove_admin(sender_hostmask, target_hostmask);
-        connection->sendCommand(IrcCommand::createMessage(target_channel, QString::fromStdString(response)));
+        db_executor().submit(this, [sender_hostmask, target_hostmask]() {
+            return remove_admin(sender_hostmask, target_hostmask);
+        }, [this, target_channel](const std::string& response) { reply(target_channel, response); });
     }
     else if (content.startsWith("!admin check ")) {
         std::string target_hostmask = content.mid(13).toStdString();
-        bool admin = is_admin(target_hostmask);
-        std::string response = admin
-            ? IRC_COLORS["color_green"] + "✅ " + target_hostmask + " is an admin." + IRC_COLORS["color_reset"]
-            : IRC_COLORS["color_red"] + "❌ " + target_hostmask + " is NOT an admin." + IRC_COLORS["color_reset"];
-        connection->sendCommand(IrcCommand::createMessage(target_channel, QString::fromStdString(response)));
+        db_executor().submit(this, [target_hostmask]() {
+            bool admin = is_admin(target_hostmask);
+            return admin
+                ? colored("color_green", "✅ " + target_hostmask + " is an admin.")
+                : colored("color_red", "❌ " + target_hostmask + " is NOT an admin.");
+        }, [this, target_channel](const std::string& response) { reply(target_channel, response); });
     }
     else if (content.startsWith("!git add ")) {
-        if (!is_admin(sender_hostmask)) {
-            std::string response = IRC_COLORS["color_red"] + "⚠️ You are not authorized to add repositories." + IRC_COLORS["color_reset"];
-            connection->sendCommand(IrcCommand::createMessage(target_channel, QString::fromStdString(response)));
-            return;
-        }
         std::string repo = content.mid(9).toStdString();
-        std::string response = add_repo(sender_hostmask, repo);
-        connection->sendCommand(IrcCommand::createMessage(target_channel, QString::fromStdString(response)));
+        db_executor().submit(this, [sender_hostmask, repo]() {
+            return add_repo(sender_hostmask, repo);  // ✅ checks admin rights itself
+        }, [this, target_channel](const std::string& response) { reply(target_channel, response); });
     }
     else if (content.startsWith("!git del ")) {
-        if (!is_admin(sender_hostmask)) {
-            std::string response = IRC_COLORS["color_red"] + "⚠️ You are not authorized to remove repositories." + IRC_COLORS["color_reset"];
-            connection->sendCommand(IrcCommand::createMessage(nick, QString::fromStdString(response)));
+        std::string repo = content.mid(9).toStdString();
+        db_executor().submit(this, [sender_hostmask, repo]() {
+            if (!is_admin(sender_hostmask)) {
+                return std::make_pair(false, colored("color_red", "⚠️ You are not authorized to remove repositories."));
+            }
+            return std::make_pair(true, remove_repo(sender_hostmask, repo));
+        }, [this, target_channel, nick](const std::pair<bool, std::string>& result) {
+            reply(result.first ? target_channel : nick, result.second);
+        });
+    }
+    else if (content.startsWith("!git search ")) {
+        // ✅ A trailing owner/name token limits the search to that repo
+        QStringList words = content.mid(12).split(' ', Qt::SkipEmptyParts);
+        SearchQuery query;
+        if (words.size() > 1 && words.last().contains('/')) {
+            query.repo = words.takeLast().toStdString();
+        }
+        query.terms = words.join(' ').toStdString();
+        if (query.terms.empty()) {
+            reply(target_channel, "Usage: !git search <terms> [owner/repo]");
             return;
         }
-        std::string repo = content.mid(9).toStdString();
-        std::string response = remove_repo(sender_hostmask, repo);
-        connection->sendCommand(IrcCommand::createMessage(target_channel, QString::fromStdString(response)));
+        runSearch(target_channel, nick, query);
+    }
+    else if (content.trimmed() == "!git more") {
+        auto session = search_sessions.find(target_channel.toStdString() + " " + nick.toStdString());
+        if (session == search_sessions.end()) {
+            reply(target_channel, "No more results.");
+            return;
+        }
+        SearchQuery query = session->second;
+        search_sessions.erase(session);
+        runSearch(target_channel, nick, query);
+    }
+    else if (content.startsWith("!git stats ")) {
+        QStringList words = content.mid(11).split(' ', Qt::SkipEmptyParts);
+        bool valid = words.size() == 1;
+        int days = STATS_DEFAULT_DAYS;
+        if (words.size() == 2) {
+            days = words[1].toInt(&valid);
+            valid = valid && days > 0 && days <= STATS_MAX_DAYS;
+        }
+        if (!valid) {
+            reply(target_channel, "Usage: !git stats <owner/repo> [days, up to " + std::to_string(STATS_MAX_DAYS) + "]");
+            return;
+        }
+        std::string repo = words[0].toStdString();
+        db_executor().submit(this, [repo, days]() {
+            try {
+                std::string stats = repo_commit_stats(repo, days);
+                return stats.empty() ? "📊 No commits stored for " + repo : stats;
+            } catch (const std::exception& e) {
+                spdlog::error("❌ Database error while reading stats for {}: {}", repo, e.what());
+                return colored("color_red", "⚠️ Stats unavailable.");
+            }
+        }, [this, target_channel](const std::string& response) { reply(target_channel, response); });
+    }
+    else if (content.startsWith("!git top ")) {
+        std::string repo = content.mid(9).trimmed().toStdString();
+        db_executor().submit(this, [repo]() {
+            try {
+                std::string top = top_committers(repo, TOP_COMMITTERS);
+                return top.empty() ? "🏆 No commits stored for " + repo : top;
+            } catch (const std::exception& e) {
+                spdlog::error("❌ Database error while reading top committers for {}: {}", repo, e.what());
+                return colored("color_red", "⚠️ Stats unavailable.");
+            }
+        }, [this, target_channel](const std::string& response) { reply(target_channel, response); });
     }
     else if (content.startsWith("!git check last ")) {
         std::string repo = content.mid(16).toStdString();
-        std::string response = get_last_commit(repo);  // ✅ Fetch directly from GitHub API
-        connection->sendCommand(IrcCommand::createMessage(target_channel, QString::fromStdString(response)));
+        http_executor().submit(this, [repo]() {
+            return get_last_commit(repo);  // ✅ Fetch directly from GitHub API
+        }, [this, target_channel](const std::string& response) { reply(target_channel, response); });
     }
-    
+}
+
+// ✅ Run one page of a commit search on the database executor and send the lines back.
+// If there are more, remember where the page ended for `!git more`.
+void IRCClient::runSearch(const QString& target, const QString& nick, const SearchQuery& query) {
+    db_executor().submit(this, [query]() {
+        try {
+            return std::make_pair(true, search_commits(query, SEARCH_PAGE_SIZE));
+        } catch (const std::exception& e) {
+            spdlog::error("❌ Database error while searching commits: {}", e.what());
+            return std::make_pair(false, SearchPage{});
+        }
+    }, [this, target, nick, query](const std::pair<bool, SearchPage>& result) {
+        const SearchPage& page = result.second;
+        if (!result.first) {
+            reply(target, colored("color_red", "⚠️ Search failed."));
+            return;
+        }
+        if (page.lines.empty()) {
+            reply(target, query.after ? "No more results." : "🔍 No commits match: " + query.terms);
+            return;
+        }
+        for (const std::string& line : page.lines) {
+            reply(target, line);
+        }
+        if (page.next) {
+            SearchQuery next = query;
+            next.after = page.next;
+            search_sessions[target.toStdString() + " " + nick.toStdString()] = next;
+            reply(target, "… more with !git more");
+        }
+    });
 }
 
 // ✅ Rehash Configuration (No Reconnect)
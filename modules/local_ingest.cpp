@@ -0,0 +1,122 @@
+#include "local_ingest.h"
+#include "common.h"
+#include "github_parser.h"
+#include "db_executor.h"
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <memory>
+#include <string>
+
+using json = nlohmann::json;
+
+static const int MAX_LINE_BYTES = 64 * 1024;
+
+LocalIngestServer::LocalIngestServer(QObject* parent) : QObject(parent) {
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server, &QLocalServer::newConnection, this, &LocalIngestServer::onNewConnection);
+}
+
+LocalIngestServer::~LocalIngestServer() = default;
+
+// ✅ Listen on `path`, replacing a socket file left behind by a previous run
+bool LocalIngestServer::start(const QString& path) {
+    QLocalServer::removeServer(path);
+    if (!server->listen(path)) {
+        spdlog::error("❌ Local ingest socket failed on {}: {}", path.toStdString(), server->errorString().toStdString());
+        return false;
+    }
+
+    spdlog::info("✅ Local ingest socket listening on {}", path.toStdString());
+    return true;
+}
+
+void LocalIngestServer::onNewConnection() {
+    while (QLocalSocket* socket = server->nextPendingConnection()) {
+        partial_lines.emplace(socket, QByteArray());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            partial_lines.erase(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+// ✅ Parse every complete line that has arrived. Consecutive events for the same repo
+// are handed to the database executor together, so a producer streaming one repo costs
+// one lookup per read.
+void LocalIngestServer::onReadyRead(QLocalSocket* socket) {
+    auto it = partial_lines.find(socket);
+    if (it == partial_lines.end()) {
+        return;
+    }
+
+    QByteArray& buffer = it->second;
+    buffer.append(socket->readAll());
+
+    auto batch = std::make_shared<PushBatch>();
+    std::string repo;
+
+    // ✅ A failed write is reported on the socket (if the producer is still connected)
+    QPointer<QLocalSocket> producer(socket);
+    auto flush = [&]() {
+        if (!batch->commits.empty()) {
+            db_executor().submit(this, [repo, batch]() {
+                return handle_local_commits(repo, batch->commits, &batch->arena);
+            }, [producer, repo, batch](bool stored) {
+                if (stored || !producer) {
+                    return;
+                }
+                std::string reply = "error: store failed for " + repo + ":";
+                for (const CommitRecord& commit : batch->commits) {
+                    reply.append(" ").append(commit.sha);
+                }
+                reply.append("\n");
+                producer->write(reply.data(), static_cast<qint64>(reply.size()));
+            });
+            batch = std::make_shared<PushBatch>();
+        }
+    };
+
+    int start = 0;
+    int end;
+    while ((end = buffer.indexOf('\n', start)) >= 0) {
+        std::string_view line(buffer.constData() + start, static_cast<size_t>(end - start));
+        start = end + 1;
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+            continue;
+        }
+
+        json event = json::parse(line, nullptr, false);
+        if (event.is_discarded() || !event.is_object() || !event.value("repo", json()).is_string() ||
+            !event.value("sha", json()).is_string()) {
+            socket->write("error: expected {\"repo\": ..., \"sha\": ...}\n");
+            continue;
+        }
+
+        std::string event_repo = event["repo"].get<std::string>();
+        if (event_repo != repo) {
+            flush();
+            repo = event_repo;
+        }
+
+        auto field = [&](const char* name) {
+            auto value = event.find(name);
+            return value != event.end() && value->is_string() ? std::string_view(value->get_ref<const std::string&>())
+                                                              : std::string_view();
+        };
+        batch->add(CommitRecord{field("sha"), field("author"), field("message"), field("timestamp")});
+    }
+    flush();
+
+    buffer.remove(0, start);
+    if (buffer.size() > MAX_LINE_BYTES) {
+        spdlog::warn("⚠️ Local ingest line over {} bytes, dropping connection", MAX_LINE_BYTES);
+        socket->write("error: line too long\n");
+        socket->disconnectFromServer();
+        buffer.clear();
+    }
+}
@@ -0,0 +1,349 @@
+#include "common.h"
+#include "db_pool.h"
+#include <pqxx/pqxx>
+#include <spdlog/spdlog.h>
+
+// ✅ Ordered schema migrations. Each runs once, in its own transaction, and is recorded
+// in schema_version. Never edit an applied migration; append a new one instead.
+// Early steps use IF NOT EXISTS so databases set up before versioning are adopted.
+struct Migration {
+    int version;
+    const char* description;
+    const char* sql;
+};
+
+static const Migration MIGRATIONS[] = {
+    {1, "baseline tables", R"(
+        CREATE TABLE IF NOT EXISTS admins (
+            id SERIAL PRIMARY KEY,
+            hostmask TEXT UNIQUE NOT NULL
+        );
+        CREATE TABLE IF NOT EXISTS commits (
+            id SERIAL PRIMARY KEY,
+            repo_name TEXT NOT NULL,
+            sha TEXT NOT NULL,
+            author TEXT NOT NULL,
+            message TEXT NOT NULL,
+            url TEXT NOT NULL,
+            additions INT DEFAULT 0,
+            deletions INT DEFAULT 0,
+            changes INT DEFAULT 0
+        );
+        CREATE TABLE IF NOT EXISTS tracked_repos (
+            repo_name TEXT PRIMARY KEY
+        );
+
+        -- X-GitHub-Delivery IDs already processed (redeliveries are dropped)
+        CREATE TABLE IF NOT EXISTS webhook_deliveries (
+            delivery_id TEXT PRIMARY KEY,
+            received_at TIMESTAMPTZ NOT NULL DEFAULT now()
+        );
+    )"},
+
+    {2, "commit columns written by store_commits()", R"(
+        ALTER TABLE commits
+            ADD COLUMN IF NOT EXISTS commit_hash TEXT,
+            ADD COLUMN IF NOT EXISTS timestamp TIMESTAMPTZ NOT NULL DEFAULT now(),
+            ALTER COLUMN url DROP NOT NULL;
+    )"},
+
+    {3, "one row per (repo, sha)", R"(
+        -- Backs ON CONFLICT (repo_name, sha) in the staging merge
+        DELETE FROM commits a USING commits b
+            WHERE a.id > b.id AND a.repo_name = b.repo_name AND a.sha = b.sha;
+        CREATE UNIQUE INDEX IF NOT EXISTS commits_repo_sha_idx ON commits (repo_name, sha);
+    )"},
+
+    {4, "tracked_repos key and checkpoint column", R"(
+        ALTER TABLE tracked_repos ADD COLUMN IF NOT EXISTS last_commit_sha TEXT;
+
+        -- Tables created by hand before versioning may lack a key
+        DELETE FROM tracked_repos a USING tracked_repos b
+            WHERE a.ctid > b.ctid AND a.repo_name = b.repo_name;
+        DO $$
+        BEGIN
+            IF NOT EXISTS (SELECT 1 FROM pg_index WHERE indrelid = 'tracked_repos'::regclass AND indisprimary) THEN
+                ALTER TABLE tracked_repos ADD PRIMARY KEY (repo_name);
+            ELSIF NOT EXISTS (
+                SELECT 1 FROM pg_index i
+                JOIN pg_attribute a ON a.attrelid = i.indrelid AND a.attnum = i.indkey[0]
+                WHERE i.indrelid = 'tracked_repos'::regclass AND i.indisunique AND i.indnatts = 1
+                  AND a.attname = 'repo_name'
+            ) THEN
+                CREATE UNIQUE INDEX tracked_repos_name_idx ON tracked_repos (repo_name);
+            END IF;
+        END $$;
+
+        -- Case-insensitive lookups of webhook and ingest repo names
+        CREATE INDEX IF NOT EXISTS tracked_repos_lower_name_idx ON tracked_repos (lower(repo_name));
+    )"},
+
+    {5, "commit time index", R"(
+        CREATE INDEX IF NOT EXISTS commits_timestamp_idx ON commits (timestamp);
+    )"},
+
+    {6, "compact commit rows: binary SHA, repo and author dictionaries", R"(
+        CREATE TABLE repos (
+            id SERIAL PRIMARY KEY,
+            name TEXT UNIQUE NOT NULL
+        );
+        CREATE TABLE authors (
+            id SERIAL PRIMARY KEY,
+            name TEXT UNIQUE NOT NULL
+        );
+
+        -- NULL instead of an error for timestamps that do not parse
+        CREATE FUNCTION try_timestamptz(value TEXT) RETURNS TIMESTAMPTZ LANGUAGE plpgsql STABLE AS $f$
+        BEGIN
+            RETURN value::timestamptz;
+        EXCEPTION WHEN others THEN
+            RETURN NULL;
+        END
+        $f$;
+
+        -- About 60 bytes of fixed columns per row instead of three free-text ones plus
+        -- the URL; the additions/deletions/changes columns were never filled in
+        CREATE TABLE commits_compact (
+            repo_id INT NOT NULL REFERENCES repos (id),
+            sha BYTEA NOT NULL,
+            author_id INT NOT NULL REFERENCES authors (id),
+            committed_at TIMESTAMPTZ NOT NULL,
+            message TEXT NOT NULL,
+            PRIMARY KEY (repo_id, sha)
+        );
+
+        INSERT INTO repos (name) SELECT DISTINCT repo_name FROM commits;
+        INSERT INTO authors (name) SELECT DISTINCT author FROM commits;
+        INSERT INTO commits_compact (repo_id, sha, author_id, committed_at, message)
+            SELECT r.id, decode(c.sha, 'hex'), a.id, c.timestamp, c.message
+            FROM commits c
+            JOIN repos r ON r.name = c.repo_name
+            JOIN authors a ON a.name = c.author
+            WHERE c.sha ~ '^([0-9a-fA-F]{2})+$'
+            ON CONFLICT DO NOTHING;
+
+        DROP TABLE commits;
+        ALTER TABLE commits_compact RENAME TO commits;
+        ALTER INDEX commits_compact_pkey RENAME TO commits_pkey;
+        CREATE INDEX commits_committed_at_idx ON commits (committed_at);
+
+        -- The old row shape, with names, hex SHA and URL derived at read time
+        CREATE VIEW commit_log AS
+            SELECT r.name AS repo_name, encode(c.sha, 'hex') AS sha, a.name AS author, c.message, c.committed_at,
+                   'https://github.com/' || r.name || '/commit/' || encode(c.sha, 'hex') AS url
+            FROM commits c
+            JOIN repos r ON r.id = c.repo_id
+            JOIN authors a ON a.id = c.author_id;
+    )"},
+
+    {7, "monthly range partitions on commit time", R"(
+        DROP VIEW commit_log;
+        ALTER TABLE commits RENAME TO commits_unpartitioned;
+        ALTER INDEX commits_pkey RENAME TO commits_unpartitioned_pkey;
+
+        -- A unique key on a partitioned table must contain the partition column. The
+        -- merge checks (repo_id, sha) across partitions itself, through this index.
+        CREATE TABLE commits (
+            repo_id INT NOT NULL REFERENCES repos (id),
+            sha BYTEA NOT NULL,
+            author_id INT NOT NULL REFERENCES authors (id),
+            committed_at TIMESTAMPTZ NOT NULL,
+            message TEXT NOT NULL,
+            PRIMARY KEY (repo_id, sha, committed_at)
+        ) PARTITION BY RANGE (committed_at);
+        CREATE INDEX commits_committed_at_idx ON commits (committed_at);
+
+        -- Rows outside every monthly partition (e.g. backfilled history)
+        CREATE TABLE commits_default PARTITION OF commits DEFAULT;
+
+        -- commits_pYYYYMM for the month starting at month_start. Rows of that month are
+        -- moved out of the default partition first, since ATTACH refuses to overlap them.
+        CREATE FUNCTION create_commit_partition(month_start TIMESTAMPTZ) RETURNS VOID LANGUAGE plpgsql AS $f$
+        DECLARE
+            part TEXT := 'commits_p' || to_char(month_start, 'YYYYMM');
+            month_end TIMESTAMPTZ := month_start + INTERVAL '1 month';
+        BEGIN
+            IF to_regclass(part) IS NOT NULL THEN
+                RETURN;
+            END IF;
+            EXECUTE format('CREATE TABLE %I (LIKE commits INCLUDING DEFAULTS INCLUDING CONSTRAINTS)', part);
+            EXECUTE format('WITH moved AS (DELETE FROM commits_default WHERE committed_at >= $1 AND committed_at < $2 '
+                           'RETURNING *) INSERT INTO %I SELECT * FROM moved', part)
+                USING month_start, month_end;
+            EXECUTE format('ALTER TABLE commits ATTACH PARTITION %I FOR VALUES FROM (%L) TO (%L)',
+                           part, month_start, month_end);
+        END
+        $f$;
+
+        -- The current month and months_ahead more
+        CREATE FUNCTION ensure_commit_partitions(months_ahead INT) RETURNS VOID LANGUAGE plpgsql AS $f$
+        BEGIN
+            FOR i IN 0..months_ahead LOOP
+                PERFORM create_commit_partition(date_trunc('month', now()) + make_interval(months => i));
+            END LOOP;
+        END
+        $f$;
+
+        -- Drop whole partitions that ended before the last keep_months full months
+        CREATE FUNCTION drop_commit_partitions(keep_months INT) RETURNS INT LANGUAGE plpgsql AS $f$
+        DECLARE
+            cutoff TIMESTAMPTZ := date_trunc('month', now()) - make_interval(months => keep_months);
+            part RECORD;
+            dropped INT := 0;
+        BEGIN
+            FOR part IN
+                SELECT c.relname FROM pg_inherits i JOIN pg_class c ON c.oid = i.inhrelid
+                WHERE i.inhparent = 'commits'::regclass AND c.relname ~ '^commits_p[0-9]{6}$'
+            LOOP
+                IF to_timestamp(substr(part.relname, 10), 'YYYYMM') + INTERVAL '1 month' <= cutoff THEN
+                    EXECUTE format('DROP TABLE %I', part.relname);
+                    dropped := dropped + 1;
+                END IF;
+            END LOOP;
+            DELETE FROM commits_default WHERE committed_at < cutoff;
+            RETURN dropped;
+        END
+        $f$;
+
+        DO $$
+        DECLARE
+            month_start TIMESTAMPTZ;
+        BEGIN
+            FOR month_start IN SELECT DISTINCT date_trunc('month', committed_at) FROM commits_unpartitioned LOOP
+                PERFORM create_commit_partition(month_start);
+            END LOOP;
+            PERFORM ensure_commit_partitions(3);
+        END $$;
+
+        INSERT INTO commits (repo_id, sha, author_id, committed_at, message)
+            SELECT repo_id, sha, author_id, committed_at, message FROM commits_unpartitioned;
+        DROP TABLE commits_unpartitioned;
+
+        CREATE VIEW commit_log AS
+            SELECT r.name AS repo_name, encode(c.sha, 'hex') AS sha, a.name AS author, c.message, c.committed_at,
+                   'https://github.com/' || r.name || '/commit/' || encode(c.sha, 'hex') AS url
+            FROM commits c
+            JOIN repos r ON r.id = c.repo_id
+            JOIN authors a ON a.id = c.author_id;
+    )"},
+
+    {8, "full-text index on commit messages", R"(
+        ALTER TABLE commits
+            ADD COLUMN message_tsv TSVECTOR GENERATED ALWAYS AS (to_tsvector('english', message)) STORED;
+        CREATE INDEX commits_message_tsv_idx ON commits USING GIN (message_tsv);
+
+        -- New partitions must carry the generated column, and rows moved out of the
+        -- default partition can only supply the plain columns
+        CREATE OR REPLACE FUNCTION create_commit_partition(month_start TIMESTAMPTZ) RETURNS VOID LANGUAGE plpgsql AS $f$
+        DECLARE
+            part TEXT := 'commits_p' || to_char(month_start, 'YYYYMM');
+            month_end TIMESTAMPTZ := month_start + INTERVAL '1 month';
+        BEGIN
+            IF to_regclass(part) IS NOT NULL THEN
+                RETURN;
+            END IF;
+            EXECUTE format('CREATE TABLE %I (LIKE commits INCLUDING DEFAULTS INCLUDING CONSTRAINTS INCLUDING GENERATED)',
+                           part);
+            EXECUTE format('WITH moved AS (DELETE FROM commits_default WHERE committed_at >= $1 AND committed_at < $2 '
+                           'RETURNING *) INSERT INTO %I (repo_id, sha, author_id, committed_at, message) '
+                           'SELECT repo_id, sha, author_id, committed_at, message FROM moved', part)
+                USING month_start, month_end;
+            EXECUTE format('ALTER TABLE commits ATTACH PARTITION %I FOR VALUES FROM (%L) TO (%L)',
+                           part, month_start, month_end);
+        END
+        $f$;
+    )"},
+
+    {9, "notify bot_cache when admins or tracked repos change", R"(
+        CREATE FUNCTION notify_cache_change() RETURNS TRIGGER LANGUAGE plpgsql AS $f$
+        BEGIN
+            PERFORM pg_notify('bot_cache', TG_TABLE_NAME);
+            RETURN NULL;
+        END
+        $f$;
+
+        CREATE TRIGGER admins_notify_cache
+            AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON admins
+            FOR EACH STATEMENT EXECUTE FUNCTION notify_cache_change();
+        -- Checkpoints rewrite last_commit_sha every cycle; only name changes matter
+        CREATE TRIGGER tracked_repos_notify_cache
+            AFTER INSERT OR DELETE OR TRUNCATE OR UPDATE OF repo_name ON tracked_repos
+            FOR EACH STATEMENT EXECUTE FUNCTION notify_cache_change();
+    )"},
+    {10, "commit statistics rollups", R"(
+        -- Kept up to date by merge_staged_commits; they outlive dropped partitions
+        CREATE TABLE commit_repo_stats (
+            repo_id INT PRIMARY KEY REFERENCES repos (id),
+            commits BIGINT NOT NULL,
+            first_commit_at TIMESTAMPTZ NOT NULL,
+            last_commit_at TIMESTAMPTZ NOT NULL
+        );
+        CREATE TABLE commit_daily_stats (
+            repo_id INT NOT NULL REFERENCES repos (id),
+            day DATE NOT NULL,  -- UTC
+            commits INT NOT NULL,
+            PRIMARY KEY (repo_id, day)
+        );
+        CREATE TABLE commit_author_stats (
+            repo_id INT NOT NULL REFERENCES repos (id),
+            author_id INT NOT NULL REFERENCES authors (id),
+            commits INT NOT NULL,
+            last_commit_at TIMESTAMPTZ NOT NULL,
+            PRIMARY KEY (repo_id, author_id)
+        );
+
+        INSERT INTO commit_repo_stats (repo_id, commits, first_commit_at, last_commit_at)
+        SELECT repo_id, count(*), min(committed_at), max(committed_at) FROM commits GROUP BY repo_id;
+        INSERT INTO commit_daily_stats (repo_id, day, commits)
+        SELECT repo_id, (committed_at AT TIME ZONE 'UTC')::date, count(*) FROM commits GROUP BY 1, 2;
+        INSERT INTO commit_author_stats (repo_id, author_id, commits, last_commit_at)
+        SELECT repo_id, author_id, count(*), max(committed_at) FROM commits GROUP BY 1, 2;
+
+        CREATE INDEX repos_lower_name_idx ON repos (lower(name));
+    )"},
+    {11, "commit keys unique across partitions", R"(
+        -- The partitioned key includes committed_at, so it cannot stop two writers (or two
+        -- deliveries with different timestamps) from storing the same commit twice. The
+        -- merge claims (repo_id, sha) here first. Keys outlive dropped partitions, so old
+        -- commits delivered again are not stored, counted or announced a second time.
+        CREATE TABLE commit_keys (
+            repo_id INT NOT NULL REFERENCES repos (id),
+            sha BYTEA NOT NULL,
+            PRIMARY KEY (repo_id, sha)
+        );
+        INSERT INTO commit_keys (repo_id, sha) SELECT DISTINCT repo_id, sha FROM commits;
+    )"},
+};
+
+// Any constant shared by every bot instance; serializes concurrent startups
+static const long long MIGRATION_LOCK = 0x62746875622d6462;  // "bthub-db"
+
+// ✅ Bring the schema up to the latest version. Throws if a migration fails; the ones
+// before it stay applied.
+void run_migrations() {
+    auto conn = db_pool().acquire();
+    {
+        pqxx::nontransaction setup(*conn);
+        setup.exec(R"(
+            CREATE TABLE IF NOT EXISTS schema_version (
+                version INT PRIMARY KEY,
+                description TEXT NOT NULL,
+                applied_at TIMESTAMPTZ NOT NULL DEFAULT now()
+            );
+        )");
+    }
+
+    for (const Migration& migration : MIGRATIONS) {
+        pqxx::work txn(*conn);
+        txn.exec_params("SELECT pg_advisory_xact_lock($1);", MIGRATION_LOCK);
+        if (!txn.exec_params("SELECT 1 FROM schema_version WHERE version = $1;", migration.version).empty()) {
+            continue;
+        }
+
+        spdlog::info("🔧 Applying schema migration {}: {}", migration.version, migration.description);
+        txn.exec(migration.sql);
+        txn.exec_params("INSERT INTO schema_version (version, description) VALUES ($1, $2);",
+                        migration.version, migration.description);
+        txn.commit();
+    }
+}
@@ -0,0 +1,76 @@
+#include "poll_schedule.h"
+#include "config.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using Clock = std::chrono::steady_clock;
+
+struct RepoSchedule {
+    Clock::time_point last_delivery{};
+    Clock::time_point last_poll{};
+    Clock::time_point distrust_until{};  // hook missed commits; poll normally until then
+    bool live = false;                   // last state logged, for transitions only
+};
+
+// ✅ Keyed by lower-cased repo name: GitHub reports canonical case, admins may not
+// (the poller executor reads it, webhook handling on the database executor writes it)
+static std::unordered_map<std::string, RepoSchedule> schedules;
+static std::mutex schedules_mutex;
+
+static RepoSchedule& schedule_for(std::string_view repo) {
+    std::string key(repo);
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::tolower(c); });
+    return schedules[key];
+}
+
+void note_webhook_delivery(std::string_view repo) {
+    std::lock_guard<std::mutex> lock(schedules_mutex);
+    schedule_for(repo).last_delivery = Clock::now();
+}
+
+PollMode poll_mode(std::string_view repo) {
+    auto settings = config();
+    std::lock_guard<std::mutex> lock(schedules_mutex);
+    RepoSchedule& schedule = schedule_for(repo);
+    Clock::time_point now = Clock::now();
+
+    bool live = settings->webhook_enabled && schedule.last_delivery != Clock::time_point{} &&
+                now - schedule.last_delivery < std::chrono::seconds(settings->webhook_liveness) &&
+                now >= schedule.distrust_until;
+
+    if (live != schedule.live) {
+        schedule.live = live;
+        if (live) {
+            spdlog::info("📬 Webhooks arriving for {}, polling only every {}s", repo, settings->webhook_verify_interval);
+        } else {
+            spdlog::info("⏰ Webhooks quiet for {}, resuming regular polling", repo);
+        }
+    }
+
+    if (!live) {
+        return PollMode::Normal;
+    }
+    if (now - schedule.last_poll < std::chrono::seconds(settings->webhook_verify_interval)) {
+        return PollMode::Skip;
+    }
+    return PollMode::Verify;
+}
+
+void note_poll(std::string_view repo, PollMode mode, bool missed) {
+    int liveness = config()->webhook_liveness;
+    std::lock_guard<std::mutex> lock(schedules_mutex);
+    RepoSchedule& schedule = schedule_for(repo);
+    Clock::time_point now = Clock::now();
+    schedule.last_poll = now;
+
+    if (mode == PollMode::Verify && missed) {
+        spdlog::warn("⚠️ Verification poll for {} found commits the webhook did not deliver, "
+                     "polling normally for {}s", repo, liveness);
+        schedule.distrust_until = now + std::chrono::seconds(liveness);
+    }
+}
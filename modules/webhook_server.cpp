@@ -0,0 +1,404 @@
+#include "webhook_server.h"
+#include "common.h"
+#include "github_parser.h"
+#include "config.h"
+#include "db_executor.h"
+#include <spdlog/spdlog.h>
+#include <QHostAddress>
+#include <QList>
+#include <QMetaObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <algorithm>
+#include <unistd.h>
+
+static const int MAX_HEADER_BYTES = 16 * 1024;
+static const qint64 MAX_BODY_BYTES = 25 * 1024 * 1024;  // GitHub caps payloads at 25 MB
+
+// Per-delivery memory ceiling while processing: one read chunk plus at most
+// BATCHES_AHEAD batches of about COMMITS_PER_BATCH capped commits
+static const size_t READ_CHUNK_BYTES = 64 * 1024;
+static const size_t COMMITS_PER_BATCH = 64;
+static const int BATCHES_AHEAD = 4;
+static const size_t MAX_UNROUTED_COMMITS = 4 * COMMITS_PER_BATCH;  // commits seen before `repository`
+static const int RETRY_DELAY_MS = 30 * 1000;  // before retrying a delivery that could not be stored
+
+WebhookServer::WebhookServer(QObject* parent) : QObject(parent), recent_deliveries(1024) {
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &WebhookServer::onNewConnection);
+}
+
+WebhookServer::~WebhookServer() {
+    stopping = true;
+    workers.waitForDone();
+}
+
+// ✅ Replay deliveries left in the spool, then start listening for new ones
+bool WebhookServer::start(const QString& address, quint16 port) {
+    workers.setMaxThreadCount(std::max(1, WEBHOOK_WORKERS));
+    if (spool.open(WEBHOOK_SPOOL_PATH)) {
+        for (uint64_t seq : spool.pending()) {
+            queued.push_back(seq);
+        }
+        dispatch();
+    }
+
+    QHostAddress host = address.isEmpty() ? QHostAddress(QHostAddress::Any) : QHostAddress(address);
+    if (!server->listen(host, port)) {
+        spdlog::error("❌ Webhook listener failed on {}:{}: {}", address.toStdString(), port,
+                      server->errorString().toStdString());
+        return false;
+    }
+
+    spdlog::info("✅ Webhook listener running on {}:{}", address.toStdString(), port);
+    return true;
+}
+
+void WebhookServer::onNewConnection() {
+    while (QTcpSocket* socket = server->nextPendingConnection()) {
+        requests.emplace(socket, Request{});
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            forget(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+// ✅ Parse headers, then pass body bytes straight through to the MAC and the spool
+void WebhookServer::onReadyRead(QTcpSocket* socket) {
+    auto it = requests.find(socket);
+    if (it == requests.end()) {
+        socket->readAll();  // already answered, drain
+        return;
+    }
+
+    Request& request = it->second;
+    if (!request.headers_done) {
+        request.buffer.append(socket->readAll());
+        if (!parseHeaders(request)) {
+            if (request.buffer.size() > MAX_HEADER_BYTES) {
+                respond(socket, 431, "Request Header Fields Too Large");
+            }
+            return;
+        }
+        if (!startBody(socket, request)) {
+            return;
+        }
+
+        // Body bytes that arrived along with the headers
+        consumeBody(request, request.buffer.constData(), request.buffer.size());
+        request.buffer.clear();
+    }
+
+    char chunk[16 * 1024];
+    qint64 got;
+    while (request.body_received < request.content_length && (got = socket->read(chunk, sizeof(chunk))) > 0) {
+        consumeBody(request, chunk, got);
+    }
+    if (request.body_received < request.content_length) {
+        return;
+    }
+
+    handleRequest(socket, request);
+}
+
+// ✅ Validate the request head and set up the MAC and (for pushes) a spool record.
+// Returns false if the request has been answered already.
+bool WebhookServer::startBody(QTcpSocket* socket, Request& request) {
+    if (request.method.isEmpty()) {
+        respond(socket, 400, "Bad Request");
+        return false;
+    }
+    if (request.method != "POST") {
+        respond(socket, 405, "Method Not Allowed");
+        return false;
+    }
+    if (request.content_length < 0) {
+        respond(socket, 411, "Length Required");
+        return false;
+    }
+    if (request.content_length > MAX_BODY_BYTES) {
+        respond(socket, 413, "Payload Too Large");
+        return false;
+    }
+
+    if (const HmacSha256Key* signing_key = signingKey()) {
+        request.mac = std::make_unique<HmacSha256>(*signing_key);
+    }
+
+    QByteArray event = request.headers.value("x-github-event");
+    if (event == "push") {
+        std::string delivery_id = request.headers.value("x-github-delivery").toStdString();
+        if (!spool.begin(event.toStdString(), delivery_id, static_cast<uint64_t>(request.content_length),
+                         request.spool_seq)) {
+            respond(socket, 503, "Service Unavailable");
+            return false;
+        }
+    }
+    return true;
+}
+
+void WebhookServer::consumeBody(Request& request, const char* data, qint64 size) {
+    size = std::min(size, request.content_length - request.body_received);
+    if (size <= 0) {
+        return;
+    }
+    if (request.mac) {
+        request.mac->update(data, static_cast<size_t>(size));
+    }
+    if (request.spool_seq) {
+        spool.write(request.spool_seq, data, static_cast<size_t>(size));
+    }
+    request.body_received += size;
+}
+
+// ✅ Keyed context for the configured secret, rebuilt only when the secret changes (rehash)
+const HmacSha256Key* WebhookServer::signingKey() {
+    if (WEBHOOK_SECRET.empty()) {
+        return nullptr;
+    }
+    if (!key || key_secret != WEBHOOK_SECRET) {
+        key = std::make_unique<HmacSha256Key>(WEBHOOK_SECRET);
+        key_secret = WEBHOOK_SECRET;
+        if (!key->valid()) {
+            spdlog::error("❌ Failed to initialize HMAC-SHA256 for webhook signatures");
+        }
+    }
+    return key.get();
+}
+
+// ✅ Parse request line and headers once the blank line has arrived.
+// Returns false while incomplete; leaves `method` empty if malformed.
+bool WebhookServer::parseHeaders(Request& request) {
+    int header_end = request.buffer.indexOf("\r\n\r\n");
+    if (header_end < 0) {
+        return false;
+    }
+
+    QList<QByteArray> lines = request.buffer.left(header_end).split('\n');
+    QList<QByteArray> request_line = lines.takeFirst().trimmed().split(' ');
+    if (request_line.size() == 3) {
+        request.method = request_line[0];
+        request.path = request_line[1];
+    }
+
+    for (const QByteArray& line : lines) {
+        int colon = line.indexOf(':');
+        if (colon > 0) {
+            request.headers.insert(line.left(colon).trimmed().toLower(), line.mid(colon + 1).trimmed());
+        }
+    }
+
+    bool ok = false;
+    qint64 length = request.headers.value("content-length").toLongLong(&ok);
+    request.content_length = ok ? length : -1;
+
+    request.buffer.remove(0, header_end + 4);
+    request.headers_done = true;
+    return true;
+}
+
+void WebhookServer::handleRequest(QTcpSocket* socket, Request& request) {
+    QByteArray event = request.headers.value("x-github-event");
+    QByteArray delivery = request.headers.value("x-github-delivery");
+
+    // ✅ Reject forged deliveries before any JSON parsing
+    if (!WEBHOOK_SECRET.empty()) {
+        QByteArray signature = request.headers.value("x-hub-signature-256");
+        if (!request.mac || !request.mac->verify(std::string_view(signature.constData(), static_cast<size_t>(signature.size())))) {
+            spdlog::warn("⚠️ Rejected webhook delivery {} with invalid signature", delivery.toStdString());
+            respond(socket, 401, "Unauthorized");
+            return;
+        }
+    }
+
+    spdlog::info("📨 Webhook delivery {} ({} event, {} bytes)", delivery.toStdString(), event.toStdString(),
+                 request.content_length);
+
+    // ✅ Quick retries are caught here; older redeliveries by the deliveries table in dispatch()
+    std::string delivery_id = delivery.toStdString();
+    if (!delivery_id.empty() && !recent_deliveries.insert(delivery_id)) {
+        spdlog::info("🔁 Duplicate webhook delivery {}, ignoring.", delivery_id);
+        respond(socket, 200, "OK", "duplicate");
+        return;
+    }
+
+    if (event == "ping") {
+        respond(socket, 200, "OK", "pong");
+    } else if (event == "push") {
+        // ✅ Persisted before acknowledging; processed later (GitHub gives up after 10 s)
+        uint64_t seq = request.spool_seq;
+        request.spool_seq = 0;
+        if (!spool.commit(seq)) {
+            recent_deliveries.erase(delivery_id);
+            respond(socket, 503, "Service Unavailable");
+            return;
+        }
+        respond(socket, 202, "Accepted", "queued");
+        queued.push_back(seq);
+        dispatch();
+    } else {
+        respond(socket, 202, "Accepted", "ignored");
+    }
+}
+
+// ✅ Hand spooled deliveries to the worker pool, one worker each, at most as many as
+// the pool has threads (a worker may wait for its batches to be handled)
+void WebhookServer::dispatch() {
+    while (!queued.empty() && in_flight.size() < static_cast<size_t>(workers.maxThreadCount())) {
+        uint64_t seq = queued.front();
+        queued.pop_front();
+
+        SpooledDelivery delivery;
+        if (!spool.locate(seq, delivery)) {
+            spool.complete(seq);
+            continue;
+        }
+
+        int fd = spool.reader();
+        if (fd < 0) {
+            queued.push_front(seq);
+            return;
+        }
+
+        auto credits = std::make_shared<QSemaphore>(BATCHES_AHEAD);
+        in_flight.push_back(Job{seq, delivery.delivery_id, {}, credits, std::make_shared<bool>(true)});
+        workers.start([this, delivery, fd, credits]() { parseDelivery(delivery, fd, credits); });
+    }
+}
+
+// ✅ Worker thread: stream a spooled body through PushStreamParser and post its commits
+// back to the event loop in batches, waiting whenever BATCHES_AHEAD are still unhandled
+void WebhookServer::parseDelivery(const SpooledDelivery& delivery, int fd, std::shared_ptr<QSemaphore> credits) {
+    uint64_t seq = delivery.seq;
+    uint64_t offset = delivery.payload_offset;
+    uint64_t size = delivery.payload_size;
+    auto batch = std::make_shared<PushBatch>();
+    PushStreamParser parser([&batch](const CommitRecord& commit) { batch->add(commit); });
+
+    auto post = [&](bool last) {
+        while (!credits->tryAcquire(1, 100)) {
+            if (stopping) {
+                return false;
+            }
+        }
+        batch->route(parser.event());
+        batch->last = last;
+        QMetaObject::invokeMethod(this, [this, seq, batch]() { onBatch(seq, batch); }, Qt::QueuedConnection);
+        batch = std::make_shared<PushBatch>();
+        return true;
+    };
+
+    // ✅ Redelivered after the in-memory window (or replayed after processing): a single
+    // empty batch just completes it
+    if (!delivery.delivery_id.empty() && webhook_delivery_seen(delivery.delivery_id)) {
+        spdlog::info("🔁 Webhook delivery {} already processed, skipping.", delivery.delivery_id);
+        ::close(fd);
+        post(true);
+        return;
+    }
+
+    std::string chunk(READ_CHUNK_BYTES, '\0');
+    bool ok = true;
+    for (uint64_t done = 0; ok && done < size;) {
+        size_t length = static_cast<size_t>(std::min<uint64_t>(chunk.size(), size - done));
+        ok = WebhookSpool::read_at(fd, &chunk[0], length, offset + done) &&
+             parser.feed(std::string_view(chunk.data(), length));
+        done += length;
+
+        if (batch->commits.size() >= COMMITS_PER_BATCH) {
+            if (!parser.event().repo.empty()) {
+                if (!post(false)) {
+                    ::close(fd);
+                    return;
+                }
+            } else if (batch->commits.size() > MAX_UNROUTED_COMMITS) {
+                spdlog::error("❌ Push delivery has commits but no repository, giving up");
+                ok = false;
+            }
+        }
+    }
+    ::close(fd);
+
+    batch->parsed = ok && parser.finish();
+    post(true);
+}
+
+// ✅ Event loop: pass batches of the oldest delivery to the (serial) database executor
+// first, so announcements keep arrival order even when later deliveries parse sooner.
+// The spool record is completed once the last batch is stored; if any batch could not
+// be, the record stays pending and the whole delivery is retried later (commits that did
+// make it are deduplicated by the merge).
+void WebhookServer::onBatch(uint64_t seq, std::shared_ptr<PushBatch> batch) {
+    for (Job& job : in_flight) {
+        if (job.seq == seq) {
+            job.batches.push_back(std::move(batch));
+            break;
+        }
+    }
+
+    while (!in_flight.empty() && !in_flight.front().batches.empty()) {
+        Job& job = in_flight.front();
+        std::shared_ptr<PushBatch> next = std::move(job.batches.front());
+        job.batches.pop_front();
+
+        bool last = next->last;
+        std::string delivery_id = last ? job.delivery_id : std::string();
+        std::shared_ptr<QSemaphore> credits = job.credits;
+        std::shared_ptr<bool> stored = job.stored;
+        db_executor().submit(this, [next, delivery_id, credits, stored]() {
+            // ✅ After a failure the rest of the delivery waits for the retry, in order
+            if (*stored) {
+                *stored = handle_push_event(*next);
+            }
+            if (*stored && !delivery_id.empty()) {
+                record_webhook_delivery(delivery_id);
+            }
+            credits->release();
+            return *stored;
+        }, [this, seq = job.seq, last](bool stored) {
+            if (!last) {
+                return;
+            }
+            if (stored) {
+                spool.complete(seq);
+                return;
+            }
+            spdlog::warn("⚠️ Webhook delivery {} could not be stored, retrying in {}s", seq, RETRY_DELAY_MS / 1000);
+            QTimer::singleShot(RETRY_DELAY_MS, this, [this, seq]() {
+                queued.push_back(seq);
+                dispatch();
+            });
+        });
+
+        if (last) {
+            in_flight.pop_front();
+        }
+    }
+
+    dispatch();
+}
+
+void WebhookServer::respond(QTcpSocket* socket, int status, const QByteArray& reason, const QByteArray& body) {
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n"
+                          "Content-Type: text/plain\r\n"
+                          "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                          "Connection: close\r\n\r\n" + body;
+    socket->write(response);
+    socket->disconnectFromHost();
+    forget(socket);
+}
+
+// ✅ Drop a connection's state, giving back a spool record it never committed
+void WebhookServer::forget(QTcpSocket* socket) {
+    auto it = requests.find(socket);
+    if (it == requests.end()) {
+        return;
+    }
+    if (it->second.spool_seq) {
+        spool.discard(it->second.spool_seq);
+    }
+    requests.erase(it);
+}
@@ -0,0 +1,14 @@
+#!/bin/bash
+# Replay a recorded GitHub push payload against the local webhook listener.
+# Usage: WEBHOOK_SECRET=... ./post_webhook.sh [payload.json] [url]
+PAYLOAD="${1:-bench/payloads/push.json}"
+URL="${2:-http://127.0.0.1:8088/}"
+SIGNATURE="sha256=$(openssl dgst -sha256 -hmac "${WEBHOOK_SECRET}" "$PAYLOAD" | awk '{print $NF}')"
+
+curl -sS -X POST "$URL" \
+    -H "Content-Type: application/json" \
+    -H "X-Hub-Signature-256: $SIGNATURE" \
+    -H "X-GitHub-Event: push" \
+    -H "X-GitHub-Delivery: local-$(date +%s%N)" \
+    --data-binary "@$PAYLOAD"
+echo
@@ -1,9 +1,11 @@
 #include "config.h"
+#include "db_pool.h"
 #include <iostream>
 #include <fstream>
 #include <pugixml.hpp>
 #include <spdlog/spdlog.h>
 #include <pqxx/pqxx>
+#include <mutex>
 
 // Define global variables
 std::string SERVER;
@@ -15,11 +17,34 @@ std::string GECOS;
 std::string SASL_ACCOUNT;
 std::string SASL_PASSWORD;
 std::string CHANNELS;
-std::string GITHUB_API_KEY;
-std::string DB_CONN;
-std::map<std::string, std::string> IRC_COLORS;
+std::string HTTP_CACHE_PATH = "run/http_cache.bin";
+std::string WEBHOOK_BIND;
+int WEBHOOK_PORT = 8088;
+std::string WEBHOOK_SECRET;
+std::string WEBHOOK_SPOOL_PATH = "run/webhook_spool.bin";
+int WEBHOOK_WORKERS = 2;
+std::string INGEST_SOCKET_PATH;
 std::map<std::string, std::string> COMMIT_COLORS;  // ✅ Added commit colors map
 
+static std::mutex config_mutex;
+static std::shared_ptr<const Config> current_config = std::make_shared<const Config>();
+
+std::shared_ptr<const Config> config() {
+    std::lock_guard<std::mutex> lock(config_mutex);
+    return current_config;
+}
+
+const std::string& Config::color(const std::string& name) const {
+    static const std::string none;
+    auto it = irc_colors.find(name);
+    return it == irc_colors.end() ? none : it->second;
+}
+
+std::string colored(const std::string& color, const std::string& text) {
+    auto settings = config();
+    return settings->color(color) + text + settings->color("color_reset");
+}
+
 // ✅ Load settings from XML config file
 void load_config() {
     std::string config_path = "/home/reverse/irc/bots/botHub/conf/config.conf";
@@ -32,6 +57,7 @@ void load_config() {
         spdlog::error("❌ Failed to open or parse config file: {}", config_path);
         exit(1);
     }
+    auto next = std::make_shared<Config>();
 
     // ✅ Read database config
     auto db_node = doc.child("database").child("db");
@@ -45,8 +71,36 @@ void load_config() {
         exit(1);
     }
 
-    DB_CONN = "dbname=" + dbname + " user=" + dbuser + " password=" + dbpass + " host=" + dbhost;
-    spdlog::info("✅ Loaded database connection string: {}", DB_CONN);
+    next->db_conn = "dbname=" + dbname + " user=" + dbuser + " password=" + dbpass + " host=" + dbhost;
+    spdlog::info("✅ Loaded database connection string: {}", next->db_conn);
+
+    auto pool_node = doc.child("database").child("pool");
+    next->db_pool_size = pool_node.attribute("size").as_int(4);
+    if (next->db_pool_size < 1) {
+        spdlog::warn("⚠️ Database pool size {} is invalid, using 1", next->db_pool_size);
+        next->db_pool_size = 1;
+    }
+    next->db_pool_timeout_ms = pool_node.attribute("timeout_ms").as_int(5000);
+
+    // ✅ Read replicas share the primary's database and credentials
+    auto replicas_node = doc.child("database").child("replicas");
+    next->db_replica_max_lag_ms = replicas_node.attribute("max_lag_ms").as_int(5000);
+    for (pugi::xml_node replica : replicas_node.children("replica")) {
+        std::string host = replica.attribute("host").as_string();
+        if (host.empty()) {
+            continue;
+        }
+        std::string conn = "dbname=" + dbname + " user=" + dbuser + " password=" + dbpass + " host=" + host;
+        if (int port = replica.attribute("port").as_int(0)) {
+            conn += " port=" + std::to_string(port);
+        }
+        next->db_replica_conns.push_back(conn);
+        spdlog::info("✅ Read replica: {} (max lag {} ms)", host, next->db_replica_max_lag_ms);
+    }
+
+    auto retention_node = doc.child("database").child("retention");
+    next->commit_retention_months = retention_node.attribute("months").as_int(0);
+    next->commit_partitions_ahead = retention_node.attribute("partitions_ahead").as_int(3);
 
     // ✅ Read IRC settings
     auto irc_node = doc.child("irc").child("server");
@@ -64,38 +118,67 @@ void load_config() {
 
     // ✅ Load GitHub API key
     pugi::xml_node github = doc.child("github").child("api_key");
-    GITHUB_API_KEY = github.attribute("value").as_string();
+    next->github_api_key = github.attribute("value").as_string();
 
-    if (GITHUB_API_KEY.empty()) {
+    if (next->github_api_key.empty()) {
         spdlog::warn("⚠️ GitHub API key not found in config!");
     } else {
         spdlog::info("✅ GitHub API key loaded.");
     }
 
+    // ✅ Load HTTP validator cache location
+    auto cache_node = doc.child("cache");
+    HTTP_CACHE_PATH = cache_node.attribute("path").as_string("run/http_cache.bin");
+
+    // ✅ Load webhook listener settings
+    auto webhook_node = doc.child("webhook");
+    next->webhook_enabled = webhook_node.attribute("enabled").as_bool(false);
+    WEBHOOK_BIND = webhook_node.attribute("bind").as_string("127.0.0.1");
+    WEBHOOK_PORT = webhook_node.attribute("port").as_int(8088);
+    WEBHOOK_SECRET = webhook_node.attribute("secret").as_string();
+    next->webhook_verify_interval = webhook_node.attribute("verify_interval").as_int(1800);
+    next->webhook_liveness = webhook_node.attribute("liveness").as_int(3600);
+    WEBHOOK_SPOOL_PATH = webhook_node.attribute("spool").as_string("run/webhook_spool.bin");
+    WEBHOOK_WORKERS = webhook_node.attribute("workers").as_int(2);
+
+    if (next->webhook_enabled) {
+        spdlog::info("✅ Webhook receiver enabled on {}:{}", WEBHOOK_BIND, WEBHOOK_PORT);
+        if (WEBHOOK_SECRET.empty()) {
+            spdlog::warn("⚠️ No webhook secret set, deliveries will not be authenticated!");
+        }
+    }
+
+    // ✅ Load local ingest socket (disabled when no path is set)
+    INGEST_SOCKET_PATH = doc.child("ingest").attribute("socket").as_string();
+
     // ✅ Load commit colors from config
     auto colors_node = doc.child("colors");
     for (pugi::xml_node color = colors_node.child("color"); color; color = color.next_sibling("color")) {
         std::string name = color.attribute("name").as_string();
         std::string value = color.attribute("value").as_string();
-        IRC_COLORS[name] = value;
+        next->irc_colors[name] = value;
     }
 
     // ✅ Load commit-specific colors
     auto commit_colors_node = doc.child("commit_colors");
+    COMMIT_COLORS.clear();
     for (pugi::xml_node color = commit_colors_node.child("color"); color; color = color.next_sibling("color")) {
         std::string name = color.attribute("name").as_string();
         std::string color_key = color.attribute("value").as_string();
 
-        if (IRC_COLORS.find(color_key) != IRC_COLORS.end()) {
-            COMMIT_COLORS[name] = IRC_COLORS[color_key];
-        } else {
-            COMMIT_COLORS[name] = IRC_COLORS["reset"]; // Default if not found
-        }
+        auto found = next->irc_colors.find(color_key);
+        COMMIT_COLORS[name] = found != next->irc_colors.end() ? found->second : next->color("reset");  // Default if not found
     }
 
-    spdlog::info("✅ Colors Loaded - {} colors found", IRC_COLORS.size());
+    spdlog::info("✅ Colors Loaded - {} colors found", next->irc_colors.size());
     spdlog::info("✅ Commit Colors Loaded - {} mappings found", COMMIT_COLORS.size());
 
+    // ✅ Publish; work already running finishes with the snapshot it started with
+    {
+        std::lock_guard<std::mutex> lock(config_mutex);
+        current_config = std::move(next);
+    }
+
     // ✅ Load default admin
     auto admin_node = doc.child("admin").child("administrator");
     std::string default_admin = admin_node.attribute("user").as_string();
@@ -103,9 +186,9 @@ void load_config() {
     if (!default_admin.empty()) {
         spdlog::info("🔧 Default admin from config: {}", default_admin);
         try {
-            pqxx::connection conn(DB_CONN);
-            pqxx::work txn(conn);
-            txn.exec("INSERT INTO admins (hostmask) VALUES (" + txn.quote(default_admin) + ") ON CONFLICT DO NOTHING;");
+            auto conn = db_pool().acquire();
+            pqxx::work txn(*conn);
+            txn.exec_params("INSERT INTO admins (hostmask) VALUES ($1) ON CONFLICT DO NOTHING;", default_admin);
             txn.commit();
             spdlog::info("✅ Default admin added to database: {}", default_admin);
         } catch (const std::exception& e) {
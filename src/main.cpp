@@ -3,10 +3,15 @@
 #include "config.h"
 #include "common.h"
 #include "logger.h"
+#include "http_cache.h"
+#include "webhook_server.h"
+#include "local_ingest.h"
+#include "db_listener.h"
 #include <spdlog/spdlog.h>
 #include <QCoreApplication>
 #include <QFile>
 #include <QTextStream>
+#include <QTimer>
 #include <csignal>
 #include <unistd.h>
 #include <filesystem>
@@ -17,6 +22,7 @@
 #define PID_FILE "run/gitbot.pid"
 
 IRCClient* botInstance = nullptr;
+static volatile std::sig_atomic_t rehash_requested = 0;
 
 // ✅ Write PID to file
 void write_pid() {
@@ -48,9 +54,8 @@ pid_t read_pid() {
 // ✅ Handle signals (Rehash, Restart, Stop)
 void signal_handler(int signum) {
     switch (signum) {
-        case SIGUSR1:  // Rehash
-            spdlog::info("🔄 Rehashing configuration...");
-            load_config();
+        case SIGUSR1:  // Rehash, picked up by the event loop
+            rehash_requested = 1;
             break;
         case SIGHUP:  // Restart
             spdlog::info("🔄 Restarting bot...");
@@ -110,7 +115,37 @@ int main(int argc, char* argv[]) {
         // ✅ Load configuration & Database
         load_config();
         initialize_database();
+        start_database_maintenance();
+
+        // ✅ Keep admin / tracked repo caches fresh via LISTEN/NOTIFY
+        DbListener cache_listener;
+        cache_listener.start();
+        http_cache().load(HTTP_CACHE_PATH);
+
+        // ✅ Start webhook receiver (polling stays as the fallback)
+        WebhookServer webhook;
+        if (config()->webhook_enabled) {
+            webhook.start(QString::fromStdString(WEBHOOK_BIND), static_cast<quint16>(WEBHOOK_PORT));
+        }
+
+        // ✅ Start local ingest socket for CI / mirrors on this host
+        LocalIngestServer ingest;
+        if (!INGEST_SOCKET_PATH.empty()) {
+            ingest.start(QString::fromStdString(INGEST_SOCKET_PATH));
+        }
     
+        // ✅ Rehash on the event loop: load_config() locks and logs, which a signal handler
+        // must not do while other threads hold those locks
+        QTimer rehash_timer;
+        QObject::connect(&rehash_timer, &QTimer::timeout, []() {
+            if (rehash_requested) {
+                rehash_requested = 0;
+                spdlog::info("🔄 Rehashing configuration...");
+                load_config();
+            }
+        });
+        rehash_timer.start(1000);
+
         // ✅ Start IRC bot
         IRCClient bot;
         botInstance = &bot;
@@ -0,0 +1,67 @@
+#include "db_executor.h"
+#include <spdlog/spdlog.h>
+
+DbExecutor::DbExecutor(std::string name) : name(std::move(name)), worker([this]() { run(); }) {}
+
+// ✅ Finish the running job, drop the rest
+DbExecutor::~DbExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        if (!jobs.empty()) {
+            spdlog::warn("⚠️ {} executor stopping with {} queued jobs", name, jobs.size());
+        }
+        jobs.clear();
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void DbExecutor::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+size_t DbExecutor::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+
+void DbExecutor::run() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        try {
+            job();
+        } catch (const std::exception& e) {
+            spdlog::error("❌ Unhandled error in {} executor: {}", name, e.what());
+        }
+    }
+}
+
+DbExecutor& db_executor() {
+    static DbExecutor executor("database");
+    return executor;
+}
+
+DbExecutor& poll_executor() {
+    static DbExecutor executor("poller");
+    return executor;
+}
+
+DbExecutor& http_executor() {
+    static DbExecutor executor("github");
+    return executor;
+}
@@ -0,0 +1,222 @@
+#include "db_pool.h"
+#include "config.h"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+
+static const auto HEALTH_CHECK_AFTER = std::chrono::seconds(30);
+static const auto LAG_CHECK_EVERY = std::chrono::seconds(5);
+
+DbPool::Handle::Handle(DbPool* pool, Pooled entry) : pool(pool), entry(std::move(entry)) {}
+
+DbPool::Handle::Handle(Handle&& other) noexcept
+    : pool(other.pool), entry(std::move(other.entry)), owner(std::move(other.owner)) {}
+
+DbPool::Handle::~Handle() {
+    if (entry.conn) {
+        pool->release(std::move(entry));
+    }
+}
+
+const char* DbPool::Handle::prepared(Statement statement) {
+    const StatementText& text = statement_text(statement);
+    size_t index = static_cast<size_t>(statement);
+    if (!entry.prepared.test(index)) {
+        entry.conn->prepare(text.name, text.sql);
+        entry.prepared.set(index);
+    }
+    return text.name;
+}
+
+DbPool::Handle DbPool::acquire() {
+    auto settings = config();
+    size_t size = static_cast<size_t>(settings->db_pool_size);
+    auto deadline = Clock::now() + std::chrono::milliseconds(settings->db_pool_timeout_ms);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (idle.empty() && open >= size) {
+        if (returned.wait_until(lock, deadline) == std::cv_status::timeout && idle.empty() && open >= size) {
+            spdlog::error("❌ Timed out after {} ms waiting for a database connection", settings->db_pool_timeout_ms);
+            throw std::runtime_error("timed out waiting for a database connection");
+        }
+    }
+
+    if (!idle.empty()) {
+        Idle slot = std::move(idle.back());
+        idle.pop_back();
+        lock.unlock();
+
+        // ✅ Health check: a server restart or failover leaves idle connections dead
+        bool healthy = slot.pooled.conn->is_open();
+        if (healthy && Clock::now() - slot.since > HEALTH_CHECK_AFTER) {
+            try {
+                pqxx::nontransaction probe(*slot.pooled.conn);
+                probe.exec("SELECT 1;");
+            } catch (const std::exception& e) {
+                spdlog::warn("⚠️ Dropping dead database connection: {}", e.what());
+                healthy = false;
+            }
+        }
+        if (healthy) {
+            return Handle(this, std::move(slot.pooled));
+        }
+        slot.pooled.conn.reset();
+    } else {
+        ++open;
+        lock.unlock();
+    }
+
+    // ✅ Open a new connection (or replace a dead one) outside the lock
+    try {
+        auto conn = std::make_unique<pqxx::connection>(conninfo.empty() ? settings->db_conn : conninfo);
+        spdlog::debug("🔌 Opened pooled database connection");
+        return Handle(this, Pooled{std::move(conn), {}});
+    } catch (...) {
+        std::lock_guard<std::mutex> relock(mutex);
+        --open;
+        returned.notify_one();
+        throw;
+    }
+}
+
+void DbPool::release(Pooled entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entry.conn->is_open()) {
+        idle.push_back(Idle{std::move(entry), Clock::now()});
+    } else {
+        --open;  // broken while leased; reopened on demand
+    }
+    returned.notify_one();
+}
+
+DbPool& db_pool() {
+    static DbPool pool;
+    return pool;
+}
+
+namespace {
+
+// A read replica's pool plus its last measured replay lag
+struct Replica {
+    explicit Replica(const std::string& conninfo) : pool(conninfo) {}
+
+    DbPool pool;
+    std::mutex checking;
+    std::chrono::steady_clock::time_point checked{};
+    std::atomic<bool> usable{false};
+};
+
+// The replicas of one db_replica_conns list, in config order
+struct ReplicaSet {
+    std::vector<std::string> conns;
+    std::vector<std::shared_ptr<Replica>> replicas;
+};
+
+// Rebuilt when a rehash changes the list. Replicas still listed keep their pool and lag
+// state; leases hold their Replica, so a removed one lives until its last lease returns.
+std::shared_ptr<const ReplicaSet> replicas() {
+    static std::mutex mutex;
+    static std::shared_ptr<const ReplicaSet> current = std::make_shared<ReplicaSet>();
+
+    auto settings = config();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current->conns == settings->db_replica_conns) {
+        return current;
+    }
+
+    auto next = std::make_shared<ReplicaSet>();
+    next->conns = settings->db_replica_conns;
+    for (const std::string& conninfo : next->conns) {
+        std::shared_ptr<Replica> replica;
+        for (size_t i = 0; i < current->conns.size(); ++i) {
+            if (current->conns[i] == conninfo) {
+                replica = current->replicas[i];
+            }
+        }
+        next->replicas.push_back(replica ? replica : std::make_shared<Replica>(conninfo));
+    }
+    spdlog::info("🔁 Using {} read replica(s)", next->replicas.size());
+    current = next;
+    return current;
+}
+
+void set_usable(Replica& replica, size_t index, bool usable, const std::string& why) {
+    if (replica.usable.exchange(usable) != usable) {
+        if (usable) {
+            spdlog::info("✅ Read replica {} is serving reads", index);
+        } else {
+            spdlog::warn("⚠️ Read replica {} taken out of rotation: {}", index, why);
+        }
+    }
+}
+
+// Re-measures the lag when it is stale. Only one thread measures a replica at a time;
+// the others go on with the last result rather than waiting on a slow host.
+bool replica_usable(Replica& replica, size_t index) {
+    std::unique_lock<std::mutex> lock(replica.checking, std::try_to_lock);
+    if (!lock.owns_lock() || std::chrono::steady_clock::now() - replica.checked < LAG_CHECK_EVERY) {
+        return replica.usable;
+    }
+    replica.checked = std::chrono::steady_clock::now();
+
+    try {
+        // Measured against the primary's WAL position: a replica whose streaming stopped
+        // has replayed all it received and would otherwise look caught up
+        std::string primary_lsn;
+        {
+            auto primary = db_pool().acquire();
+            pqxx::nontransaction txn(*primary);
+            primary_lsn = txn.exec("SELECT pg_current_wal_lsn()::text;")[0][0].as<std::string>();
+        }
+
+        auto conn = replica.pool.acquire();
+        pqxx::nontransaction probe(*conn);
+        // Bytes of that WAL not replayed yet (NULL when not in recovery), whether a WAL
+        // receiver is running, and the age of the last replayed transaction
+        pqxx::row lag = probe.exec_params(
+            "SELECT pg_wal_lsn_diff($1::pg_lsn, pg_last_wal_replay_lsn()), "
+            "EXISTS (SELECT 1 FROM pg_stat_wal_receiver), "
+            "EXTRACT(EPOCH FROM now() - pg_last_xact_replay_timestamp()) * 1000;",
+            primary_lsn)[0];
+        if (lag[0].is_null()) {
+            set_usable(replica, index, false, "not a standby");
+        } else if (!lag[1].as<bool>()) {
+            set_usable(replica, index, false, "WAL receiver is not running");
+        } else {
+            double lag_ms = 0;
+            if (lag[0].as<double>() > 0) {
+                lag_ms = lag[2].is_null() ? std::numeric_limits<double>::infinity() : lag[2].as<double>();
+            }
+            set_usable(replica, index, lag_ms <= config()->db_replica_max_lag_ms,
+                       fmt::format("{:.0f} ms behind the primary", lag_ms));
+        }
+    } catch (const std::exception& e) {
+        set_usable(replica, index, false, e.what());
+    }
+    return replica.usable;
+}
+
+}  // namespace
+
+DbPool::Handle db_read() {
+    static std::atomic<size_t> next{0};
+    auto set = replicas();
+    const auto& list = set->replicas;
+
+    for (size_t tried = 0; tried < list.size(); ++tried) {
+        size_t index = next++ % list.size();
+        Replica& replica = *list[index];
+        if (!replica_usable(replica, index)) {
+            continue;
+        }
+        try {
+            DbPool::Handle conn = replica.pool.acquire();
+            conn.hold(list[index]);
+            return conn;
+        } catch (const std::exception& e) {
+            set_usable(replica, index, false, e.what());
+        }
+    }
+    return db_pool().acquire();
+}
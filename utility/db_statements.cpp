@@ -0,0 +1,105 @@
+#include "db_statements.h"
+
+// Indexed by Statement
+static const StatementText STATEMENTS[STATEMENT_COUNT] = {
+    {"is_admin", "SELECT 1 FROM admins WHERE hostmask = $1 LIMIT 1"},
+    {"all_admins", "SELECT hostmask FROM admins"},
+    // A statement of its own, so the merge (next statement, new snapshot) sees names
+    // that concurrent writers added first
+    {"add_staged_names",
+     "WITH new_repos AS ("
+     "  INSERT INTO repos (name) SELECT DISTINCT repo_name FROM commit_staging ON CONFLICT (name) DO NOTHING"
+     ") "
+     "INSERT INTO authors (name) SELECT DISTINCT author FROM commit_staging ON CONFLICT (name) DO NOTHING"},
+    // Rows whose SHA or timestamp does not parse are left out (not stored, not announced).
+    // A commit is new only if this statement claims its commit_keys row; a concurrent
+    // writer of the same key waits for ours and then skips it.
+    {"merge_staged_commits",
+     "WITH staged AS ("
+     "  SELECT DISTINCT ON (r.id, decode(s.sha, 'hex'))"
+     "         r.id AS repo_id, decode(s.sha, 'hex') AS sha, a.id AS author_id,"
+     "         try_timestamptz(s.committed_at) AS committed_at, s.message,"
+     "         s.repo_name, s.sha AS sha_hex"
+     "  FROM commit_staging s"
+     "  JOIN repos r ON r.name = s.repo_name"
+     "  JOIN authors a ON a.name = s.author"
+     "  WHERE s.sha ~ '^([0-9a-fA-F]{2})+$' AND try_timestamptz(s.committed_at) IS NOT NULL"
+     "), new_keys AS ("
+     "  INSERT INTO commit_keys (repo_id, sha)"
+     "  SELECT repo_id, sha FROM staged ORDER BY repo_id, sha"
+     "  ON CONFLICT (repo_id, sha) DO NOTHING"
+     "  RETURNING repo_id, sha"
+     "), inserted AS ("
+     "  INSERT INTO commits (repo_id, sha, author_id, committed_at, message)"
+     "  SELECT s.repo_id, s.sha, s.author_id, s.committed_at, s.message"
+     "  FROM staged s JOIN new_keys k ON k.repo_id = s.repo_id AND k.sha = s.sha"
+     "  RETURNING repo_id, sha, author_id, committed_at"
+     // Rollups move in the same statement as the rows they count; sorted upserts keep
+     // concurrent batches from deadlocking on each other's rows
+     "), repo_totals AS ("
+     "  INSERT INTO commit_repo_stats (repo_id, commits, first_commit_at, last_commit_at)"
+     "  SELECT repo_id, count(*), min(committed_at), max(committed_at) FROM inserted GROUP BY repo_id ORDER BY repo_id"
+     "  ON CONFLICT (repo_id) DO UPDATE SET"
+     "    commits = commit_repo_stats.commits + EXCLUDED.commits,"
+     "    first_commit_at = LEAST(commit_repo_stats.first_commit_at, EXCLUDED.first_commit_at),"
+     "    last_commit_at = GREATEST(commit_repo_stats.last_commit_at, EXCLUDED.last_commit_at)"
+     "), daily AS ("
+     "  INSERT INTO commit_daily_stats (repo_id, day, commits)"
+     "  SELECT repo_id, (committed_at AT TIME ZONE 'UTC')::date, count(*) FROM inserted GROUP BY 1, 2 ORDER BY 1, 2"
+     "  ON CONFLICT (repo_id, day) DO UPDATE SET commits = commit_daily_stats.commits + EXCLUDED.commits"
+     "), by_author AS ("
+     "  INSERT INTO commit_author_stats (repo_id, author_id, commits, last_commit_at)"
+     "  SELECT repo_id, author_id, count(*), max(committed_at) FROM inserted GROUP BY 1, 2 ORDER BY 1, 2"
+     "  ON CONFLICT (repo_id, author_id) DO UPDATE SET"
+     "    commits = commit_author_stats.commits + EXCLUDED.commits,"
+     "    last_commit_at = GREATEST(commit_author_stats.last_commit_at, EXCLUDED.last_commit_at)"
+     ") "
+     "SELECT s.repo_name, s.sha_hex FROM inserted i JOIN staged s ON s.repo_id = i.repo_id AND s.sha = i.sha"},
+    {"tracked_repos", "SELECT repo_name, last_commit_sha FROM tracked_repos"},
+    {"checkpoint_repos",
+     "UPDATE tracked_repos SET last_commit_sha = c.sha "
+     "FROM unnest($1::text[], $2::text[]) AS c(repo_name, sha) "
+     "WHERE tracked_repos.repo_name = c.repo_name"},
+    // Newest first; the (committed_at, repo_id, sha) keyset continues where a page ended
+    {"search_commits",
+     "SELECT r.name, encode(c.sha, 'hex'), a.name, c.message, c.committed_at::text, c.repo_id "
+     "FROM commits c "
+     "JOIN repos r ON r.id = c.repo_id "
+     "JOIN authors a ON a.id = c.author_id "
+     "WHERE c.message_tsv @@ websearch_to_tsquery('english', $1) "
+     "  AND ($2::text IS NULL OR c.repo_id = (SELECT id FROM repos WHERE lower(name) = lower($2) LIMIT 1)) "
+     "  AND ($3::timestamptz IS NULL OR (c.committed_at, c.repo_id, c.sha) < ($3, $4::int, decode($5::text, 'hex'))) "
+     "ORDER BY c.committed_at DESC, c.repo_id DESC, c.sha DESC "
+     "LIMIT $6"},
+    // One row per day with commits, so the window costs O(days) whatever the history
+    {"repo_stats",
+     "SELECT r.name, t.commits, t.first_commit_at::date::text, t.last_commit_at::date::text,"
+     "       COALESCE(w.commits, 0), w.days, b.day::text, b.commits "
+     "FROM repos r "
+     "JOIN commit_repo_stats t ON t.repo_id = r.id "
+     "CROSS JOIN LATERAL ("
+     "  SELECT sum(d.commits) AS commits, count(*) AS days FROM commit_daily_stats d"
+     "  WHERE d.repo_id = r.id AND d.day > (now() AT TIME ZONE 'UTC')::date - $2::int"
+     ") w "
+     "LEFT JOIN LATERAL ("
+     "  SELECT d.day, d.commits FROM commit_daily_stats d"
+     "  WHERE d.repo_id = r.id AND d.day > (now() AT TIME ZONE 'UTC')::date - $2::int"
+     "  ORDER BY d.commits DESC, d.day DESC LIMIT 1"
+     ") b ON true "
+     "WHERE r.id = (SELECT id FROM repos WHERE lower(name) = lower($1) LIMIT 1)"},
+    {"top_authors",
+     "SELECT r.name, a.name, s.commits, t.commits "
+     "FROM repos r "
+     "JOIN commit_repo_stats t ON t.repo_id = r.id "
+     "JOIN commit_author_stats s ON s.repo_id = r.id "
+     "JOIN authors a ON a.id = s.author_id "
+     "WHERE r.id = (SELECT id FROM repos WHERE lower(name) = lower($1) LIMIT 1) "
+     "ORDER BY s.commits DESC, a.name "
+     "LIMIT $2"},
+    {"delivery_seen", "SELECT 1 FROM webhook_deliveries WHERE delivery_id = $1"},
+    {"record_delivery", "INSERT INTO webhook_deliveries (delivery_id) VALUES ($1) ON CONFLICT DO NOTHING"},
+};
+
+const StatementText& statement_text(Statement statement) {
+    return STATEMENTS[static_cast<std::size_t>(statement)];
+}
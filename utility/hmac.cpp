@@ -0,0 +1,80 @@
+#include "hmac.h"
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/params.h>
+
+static const size_t SHA256_BYTES = 32;
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+HmacSha256Key::HmacSha256Key(const std::string& secret) {
+    mac = EVP_MAC_fetch(nullptr, "HMAC", nullptr);
+    if (!mac) {
+        return;
+    }
+
+    keyed = EVP_MAC_CTX_new(mac);
+    char digest[] = "SHA256";
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+        OSSL_PARAM_construct_end()
+    };
+
+    if (!keyed || !EVP_MAC_init(keyed, reinterpret_cast<const unsigned char*>(secret.data()), secret.size(), params)) {
+        EVP_MAC_CTX_free(keyed);
+        keyed = nullptr;
+    }
+}
+
+HmacSha256Key::~HmacSha256Key() {
+    EVP_MAC_CTX_free(keyed);
+    EVP_MAC_free(mac);
+}
+
+EVP_MAC_CTX* HmacSha256Key::clone() const {
+    return keyed ? EVP_MAC_CTX_dup(keyed) : nullptr;
+}
+
+HmacSha256::HmacSha256(const HmacSha256Key& key) : ctx(key.clone()) {}
+
+HmacSha256::~HmacSha256() {
+    EVP_MAC_CTX_free(ctx);
+}
+
+void HmacSha256::update(const char* data, size_t length) {
+    if (ctx && length > 0) {
+        EVP_MAC_update(ctx, reinterpret_cast<const unsigned char*>(data), length);
+    }
+}
+
+bool HmacSha256::verify(std::string_view signature_header) {
+    static constexpr std::string_view prefix = "sha256=";
+    if (!ctx || signature_header.substr(0, prefix.size()) != prefix ||
+        signature_header.size() != prefix.size() + 2 * SHA256_BYTES) {
+        return false;
+    }
+
+    unsigned char expected[SHA256_BYTES];
+    std::string_view hex = signature_header.substr(prefix.size());
+    for (size_t i = 0; i < SHA256_BYTES; ++i) {
+        int high = hex_value(hex[2 * i]);
+        int low = hex_value(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        expected[i] = static_cast<unsigned char>((high << 4) | low);
+    }
+
+    unsigned char actual[SHA256_BYTES];
+    size_t actual_length = 0;
+    if (!EVP_MAC_final(ctx, actual, &actual_length, sizeof(actual)) || actual_length != SHA256_BYTES) {
+        return false;
+    }
+
+    return CRYPTO_memcmp(actual, expected, SHA256_BYTES) == 0;
+}
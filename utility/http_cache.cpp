@@ -0,0 +1,279 @@
+#include "http_cache.h"
+#include <spdlog/spdlog.h>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// On-disk layout:
+//   "BHC1" magic
+//   repeated records: [u32 payload_len][u32 checksum][payload]
+//   payload: [u16 url_len][u16 etag_len][u16 lm_len][u64 digest][url][etag][last_modified]
+// A later record for the same URL supersedes earlier ones. A torn record at the tail
+// (crash mid-append) fails its checksum and is truncated away on the next load.
+
+static const char CACHE_MAGIC[4] = {'B', 'H', 'C', '1'};
+static const size_t RECORD_HEADER_SIZE = 8;
+static const size_t PAYLOAD_FIXED_SIZE = 3 * sizeof(uint16_t) + sizeof(uint64_t);
+static const size_t COMPACT_MIN_BYTES = 64 * 1024;
+
+static uint32_t checksum32(const char* data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static size_t record_size(const std::string& url, const HttpCacheEntry& entry) {
+    return RECORD_HEADER_SIZE + PAYLOAD_FIXED_SIZE + url.size() + entry.etag.size() + entry.last_modified.size();
+}
+
+static std::string encode_record(const std::string& url, const HttpCacheEntry& entry) {
+    std::string payload;
+    payload.reserve(PAYLOAD_FIXED_SIZE + url.size() + entry.etag.size() + entry.last_modified.size());
+
+    uint16_t lengths[3] = {
+        static_cast<uint16_t>(url.size()),
+        static_cast<uint16_t>(entry.etag.size()),
+        static_cast<uint16_t>(entry.last_modified.size())
+    };
+    payload.append(reinterpret_cast<const char*>(lengths), sizeof(lengths));
+    payload.append(reinterpret_cast<const char*>(&entry.body_digest), sizeof(entry.body_digest));
+    payload += url;
+    payload += entry.etag;
+    payload += entry.last_modified;
+
+    uint32_t header[2] = {static_cast<uint32_t>(payload.size()), checksum32(payload.data(), payload.size())};
+    std::string record(reinterpret_cast<const char*>(header), sizeof(header));
+    record += payload;
+    return record;
+}
+
+uint64_t HttpCache::digest(const std::string& body) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : body) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+HttpCache::~HttpCache() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+// ✅ Map the cache file and rebuild the in-memory index from its records
+bool HttpCache::load(const std::string& cache_path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    path = cache_path;
+    entries.clear();
+    live_bytes = 0;
+    file_size = 0;
+
+    int read_fd = ::open(path.c_str(), O_RDONLY);
+    if (read_fd < 0) {
+        spdlog::info("🗄️ No HTTP cache at {}, starting empty.", path);
+        return open_for_append();
+    }
+
+    struct stat st {};
+    if (fstat(read_fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CACHE_MAGIC))) {
+        ::close(read_fd);
+        spdlog::warn("⚠️ HTTP cache {} is empty or unreadable, recreating.", path);
+        ::unlink(path.c_str());
+        return open_for_append();
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, read_fd, 0);
+    ::close(read_fd);
+    if (mapped == MAP_FAILED) {
+        spdlog::error("❌ Failed to map HTTP cache {}", path);
+        return open_for_append();
+    }
+
+    const char* data = static_cast<const char*>(mapped);
+    if (std::memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) {
+        munmap(mapped, size);
+        spdlog::warn("⚠️ HTTP cache {} has an unknown format, recreating.", path);
+        ::unlink(path.c_str());
+        return open_for_append();
+    }
+
+    size_t offset = sizeof(CACHE_MAGIC);
+    while (offset + RECORD_HEADER_SIZE <= size) {
+        uint32_t header[2];
+        std::memcpy(header, data + offset, sizeof(header));
+        size_t payload_len = header[0];
+        const char* payload = data + offset + RECORD_HEADER_SIZE;
+
+        if (payload_len < PAYLOAD_FIXED_SIZE || offset + RECORD_HEADER_SIZE + payload_len > size ||
+            checksum32(payload, payload_len) != header[1]) {
+            break;
+        }
+
+        uint16_t lengths[3];
+        std::memcpy(lengths, payload, sizeof(lengths));
+        if (PAYLOAD_FIXED_SIZE + lengths[0] + lengths[1] + lengths[2] != payload_len) {
+            break;
+        }
+
+        HttpCacheEntry entry;
+        std::memcpy(&entry.body_digest, payload + sizeof(lengths), sizeof(entry.body_digest));
+        const char* strings = payload + PAYLOAD_FIXED_SIZE;
+        std::string url(strings, lengths[0]);
+        entry.etag.assign(strings + lengths[0], lengths[1]);
+        entry.last_modified.assign(strings + lengths[0] + lengths[1], lengths[2]);
+
+        auto existing = entries.find(url);
+        if (existing != entries.end()) {
+            live_bytes -= record_size(url, existing->second);
+        }
+        live_bytes += RECORD_HEADER_SIZE + payload_len;
+        entries[url] = std::move(entry);
+
+        offset += RECORD_HEADER_SIZE + payload_len;
+    }
+    munmap(mapped, size);
+
+    if (offset < size) {
+        spdlog::warn("⚠️ Truncating {} bytes of torn HTTP cache records.", size - offset);
+        if (truncate(path.c_str(), static_cast<off_t>(offset)) != 0) {
+            spdlog::error("❌ Failed to truncate HTTP cache {}", path);
+        }
+    }
+
+    file_size = offset;
+    spdlog::info("✅ HTTP cache loaded: {} URLs from {}", entries.size(), path);
+
+    if (!open_for_append()) {
+        return false;
+    }
+    if (file_size > COMPACT_MIN_BYTES && file_size > 2 * live_bytes) {
+        compact_locked();
+    }
+    return true;
+}
+
+bool HttpCache::open_for_append() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd < 0) {
+        spdlog::error("❌ Failed to open HTTP cache {} for writing", path);
+        return false;
+    }
+
+    // ✅ Size from the file itself: load() may get here without having mapped an existing
+    // file, and a second magic in the middle would corrupt it
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        spdlog::error("❌ Failed to stat HTTP cache {}", path);
+        return false;
+    }
+    file_size = static_cast<size_t>(st.st_size);
+
+    if (file_size == 0) {
+        if (::write(fd, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != static_cast<ssize_t>(sizeof(CACHE_MAGIC))) {
+            spdlog::error("❌ Failed to initialize HTTP cache {}", path);
+            return false;
+        }
+        file_size = sizeof(CACHE_MAGIC);
+    }
+    return true;
+}
+
+bool HttpCache::find(const std::string& url, HttpCacheEntry& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(url);
+    if (it == entries.end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+// ✅ Remember validators for a URL (no-op when nothing changed)
+void HttpCache::store(const std::string& url, const HttpCacheEntry& entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(url);
+    if (it != entries.end()) {
+        const HttpCacheEntry& current = it->second;
+        if (current.etag == entry.etag && current.last_modified == entry.last_modified &&
+            current.body_digest == entry.body_digest) {
+            return;
+        }
+        live_bytes -= record_size(url, current);
+    }
+
+    entries[url] = entry;
+    live_bytes += record_size(url, entry);
+
+    if (!append_record(url, entry)) {
+        return;
+    }
+    if (file_size > COMPACT_MIN_BYTES && file_size > 2 * live_bytes) {
+        compact_locked();
+    }
+}
+
+bool HttpCache::append_record(const std::string& url, const HttpCacheEntry& entry) {
+    if (fd < 0 || url.size() > UINT16_MAX || entry.etag.size() > UINT16_MAX || entry.last_modified.size() > UINT16_MAX) {
+        return false;
+    }
+
+    std::string record = encode_record(url, entry);
+    if (::write(fd, record.data(), record.size()) != static_cast<ssize_t>(record.size())) {
+        spdlog::error("❌ Failed to append to HTTP cache {}", path);
+        return false;
+    }
+    file_size += record.size();
+    return true;
+}
+
+void HttpCache::compact() {
+    std::lock_guard<std::mutex> lock(mutex);
+    compact_locked();
+}
+
+// ✅ Rewrite the cache with only the live record per URL
+void HttpCache::compact_locked() {
+    std::string tmp_path = path + ".tmp";
+    int tmp_fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (tmp_fd < 0) {
+        spdlog::error("❌ Failed to create {} for compaction", tmp_path);
+        return;
+    }
+
+    std::string buffer(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    for (const auto& [url, entry] : entries) {
+        buffer += encode_record(url, entry);
+    }
+
+    bool ok = ::write(tmp_fd, buffer.data(), buffer.size()) == static_cast<ssize_t>(buffer.size()) && fsync(tmp_fd) == 0;
+    ::close(tmp_fd);
+
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        spdlog::error("❌ HTTP cache compaction failed, keeping {}", path);
+        ::unlink(tmp_path.c_str());
+        return;
+    }
+
+    spdlog::info("🗜️ HTTP cache compacted: {} -> {} bytes", file_size, buffer.size());
+    file_size = buffer.size();
+    live_bytes = buffer.size() - sizeof(CACHE_MAGIC);
+    open_for_append();
+}
+
+HttpCache& http_cache() {
+    static HttpCache cache;
+    return cache;
+}
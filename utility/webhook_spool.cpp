@@ -0,0 +1,368 @@
+#include "webhook_spool.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// On-disk layout:
+//   "BWS1" magic
+//   repeated records: [u32 kind][u32 body_len][body][u32 checksum(body)]
+//   delivery body ('D'): [u64 seq][u16 event_len][u16 delivery_len][event][delivery_id][payload]
+//   done body ('F'):     [u64 seq]
+//   discarded ('X'):     a delivery slot that was abandoned; skipped unread
+// Several deliveries can be streaming into their reserved slots at once. A record whose
+// checksum fails (never finished) is skipped; one running past the end of the file
+// (crash mid-append) is truncated away on the next open().
+
+static const char SPOOL_MAGIC[4] = {'B', 'W', 'S', '1'};
+static const uint32_t KIND_DELIVERY = 'D';
+static const uint32_t KIND_DONE = 'F';
+static const uint32_t KIND_DISCARDED = 'X';
+static const size_t RECORD_HEADER_SIZE = 2 * sizeof(uint32_t);
+static const size_t RECORD_TRAILER_SIZE = sizeof(uint32_t);
+static const size_t DELIVERY_FIXED_SIZE = sizeof(uint64_t) + 2 * sizeof(uint16_t);
+static const uint64_t TRUNCATE_MIN_BYTES = 1024 * 1024;
+
+static const uint32_t CHECKSUM_SEED = 2166136261u;
+
+static uint32_t checksum32(const char* data, size_t len, uint32_t hash = CHECKSUM_SEED) {
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool write_all(int fd, const char* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+bool WebhookSpool::read_at(int fd, char* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t got = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        size -= static_cast<size_t>(got);
+        offset += static_cast<uint64_t>(got);
+    }
+    return true;
+}
+
+WebhookSpool::~WebhookSpool() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+// ✅ Open (or create) the spool and find deliveries that never got a done marker
+bool WebhookSpool::open(const std::string& spool_path) {
+    path = spool_path;
+    pending_records.clear();
+    receiving.clear();
+    file_size = 0;
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        spdlog::error("❌ Failed to open webhook spool {}", path);
+        return false;
+    }
+
+    struct stat st {};
+    size_t size = fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    size_t offset = sizeof(SPOOL_MAGIC);
+
+    void* mapped = size >= sizeof(SPOOL_MAGIC) ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    const char* data = mapped == MAP_FAILED ? nullptr : static_cast<const char*>(mapped);
+
+    if (!data || std::memcmp(data, SPOOL_MAGIC, sizeof(SPOOL_MAGIC)) != 0) {
+        if (size > 0) {
+            spdlog::warn("⚠️ Webhook spool {} is unreadable, starting empty.", path);
+        }
+        offset = 0;
+    }
+
+    while (data && offset > 0 && offset + RECORD_HEADER_SIZE <= size) {
+        uint32_t header[2];
+        std::memcpy(header, data + offset, sizeof(header));
+        size_t body_len = header[1];
+        size_t record_end = offset + RECORD_HEADER_SIZE + body_len + RECORD_TRAILER_SIZE;
+        if (record_end > size) {
+            break;
+        }
+
+        const char* body = data + offset + RECORD_HEADER_SIZE;
+        uint32_t checksum;
+        std::memcpy(&checksum, body + body_len, sizeof(checksum));
+
+        if (header[0] == KIND_DISCARDED) {
+            // abandoned slot
+        } else if (checksum32(body, body_len) != checksum) {
+            spdlog::warn("⚠️ Skipping corrupt webhook spool record at byte {}", offset);
+        } else if (header[0] == KIND_DELIVERY && body_len >= DELIVERY_FIXED_SIZE) {
+            uint64_t seq;
+            std::memcpy(&seq, body, sizeof(seq));
+            pending_records[seq] = Location{offset + RECORD_HEADER_SIZE, static_cast<uint32_t>(body_len)};
+            next_seq = std::max(next_seq, seq + 1);
+        } else if (header[0] == KIND_DONE && body_len == sizeof(uint64_t)) {
+            uint64_t seq;
+            std::memcpy(&seq, body, sizeof(seq));
+            pending_records.erase(seq);
+        }
+        offset = record_end;
+    }
+
+    if (data) {
+        munmap(mapped, size);
+    }
+
+    if (offset < size && offset > 0) {
+        spdlog::warn("⚠️ Truncating {} bytes of torn webhook spool records.", size - offset);
+    }
+    file_size = offset;
+
+    if (!rewrite_pending()) {
+        return false;
+    }
+    if (!pending_records.empty()) {
+        spdlog::info("📥 Webhook spool {}: {} deliveries to replay", path, pending_records.size());
+    }
+    return true;
+}
+
+// ✅ Drop processed records: rewrite the pending ones into a fresh file (or just reset it)
+bool WebhookSpool::rewrite_pending() {
+    if (pending_records.empty()) {
+        if (ftruncate(fd, 0) != 0 || !write_all(fd, SPOOL_MAGIC, sizeof(SPOOL_MAGIC), 0)) {
+            spdlog::error("❌ Failed to reset webhook spool {}", path);
+            return false;
+        }
+        file_size = sizeof(SPOOL_MAGIC);
+        return true;
+    }
+
+    std::string tmp_path = path + ".tmp";
+    int tmp_fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (tmp_fd < 0) {
+        spdlog::error("❌ Failed to create {} for compaction", tmp_path);
+        return false;
+    }
+
+    bool ok = write_all(tmp_fd, SPOOL_MAGIC, sizeof(SPOOL_MAGIC), 0);
+    uint64_t tmp_size = sizeof(SPOOL_MAGIC);
+    std::map<uint64_t, Location> moved;
+    std::string record;
+    for (const auto& [seq, location] : pending_records) {
+        if (!ok) {
+            break;
+        }
+        record.resize(RECORD_HEADER_SIZE + location.size + RECORD_TRAILER_SIZE);
+        ok = read_at(fd, &record[0], record.size(), location.offset - RECORD_HEADER_SIZE) &&
+             write_all(tmp_fd, record.data(), record.size(), tmp_size);
+        moved[seq] = Location{tmp_size + RECORD_HEADER_SIZE, location.size};
+        tmp_size += record.size();
+    }
+
+    ok = ok && fsync(tmp_fd) == 0;
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        ::close(tmp_fd);
+        ::unlink(tmp_path.c_str());
+        spdlog::error("❌ Webhook spool compaction failed, keeping {}", path);
+        return false;
+    }
+
+    ::close(fd);
+    fd = tmp_fd;
+    file_size = tmp_size;
+    pending_records = std::move(moved);
+    return true;
+}
+
+bool WebhookSpool::append_record(uint32_t kind, const std::string& body) {
+    if (fd < 0) {
+        return false;
+    }
+
+    uint32_t header[2] = {kind, static_cast<uint32_t>(body.size())};
+    uint32_t checksum = checksum32(body.data(), body.size());
+
+    std::string record(reinterpret_cast<const char*>(header), sizeof(header));
+    record += body;
+    record.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+
+    if (!write_all(fd, record.data(), record.size(), file_size)) {
+        spdlog::error("❌ Failed to append to webhook spool {}", path);
+        return false;
+    }
+    file_size += record.size();
+    return true;
+}
+
+// ✅ Reserve a record for an incoming delivery and write everything but the body
+bool WebhookSpool::begin(std::string_view event, std::string_view delivery_id, uint64_t payload_size, uint64_t& seq) {
+    uint64_t body_size = DELIVERY_FIXED_SIZE + event.size() + delivery_id.size() + payload_size;
+    if (fd < 0 || event.size() > UINT16_MAX || delivery_id.size() > UINT16_MAX || body_size > UINT32_MAX) {
+        return false;
+    }
+
+    seq = next_seq;
+    uint16_t lengths[2] = {static_cast<uint16_t>(event.size()), static_cast<uint16_t>(delivery_id.size())};
+    uint32_t header[2] = {KIND_DELIVERY, static_cast<uint32_t>(body_size)};
+
+    std::string prefix;
+    prefix.append(reinterpret_cast<const char*>(&seq), sizeof(seq));
+    prefix.append(reinterpret_cast<const char*>(lengths), sizeof(lengths));
+    prefix.append(event).append(delivery_id);
+
+    std::string record(reinterpret_cast<const char*>(header), sizeof(header));
+    record += prefix;
+    if (!write_all(fd, record.data(), record.size(), file_size)) {
+        spdlog::error("❌ Failed to append to webhook spool {}", path);
+        return false;
+    }
+
+    Location location{file_size + RECORD_HEADER_SIZE, static_cast<uint32_t>(body_size)};
+    receiving[seq] = Slot{location, prefix.size(), checksum32(prefix.data(), prefix.size()), false};
+    file_size += RECORD_HEADER_SIZE + body_size + RECORD_TRAILER_SIZE;
+    ++next_seq;
+    return true;
+}
+
+// ✅ Append body bytes to a reserved record
+bool WebhookSpool::write(uint64_t seq, const char* data, size_t size) {
+    auto it = receiving.find(seq);
+    if (it == receiving.end()) {
+        return false;
+    }
+
+    Slot& slot = it->second;
+    if (slot.failed || slot.written + size > slot.location.size) {
+        slot.failed = true;
+        return false;
+    }
+    if (!write_all(fd, data, size, slot.location.offset + slot.written)) {
+        spdlog::error("❌ Failed to write to webhook spool {}", path);
+        slot.failed = true;
+        return false;
+    }
+    slot.checksum = checksum32(data, size, slot.checksum);
+    slot.written += size;
+    return true;
+}
+
+// ✅ Seal a fully received record; from here on it is replayed until complete().
+// Durable on return: the caller acknowledges the delivery, and GitHub will not resend it.
+bool WebhookSpool::commit(uint64_t seq) {
+    auto it = receiving.find(seq);
+    if (it == receiving.end()) {
+        return false;
+    }
+
+    Slot slot = it->second;
+    if (slot.failed || slot.written != slot.location.size ||
+        !write_all(fd, reinterpret_cast<const char*>(&slot.checksum), sizeof(slot.checksum),
+                   slot.location.offset + slot.location.size)) {
+        discard(seq);
+        return false;
+    }
+    if (fdatasync(fd) != 0) {
+        spdlog::error("❌ Failed to sync webhook spool {}", path);
+        discard(seq);
+        return false;
+    }
+
+    receiving.erase(it);
+    pending_records[seq] = slot.location;
+    return true;
+}
+
+// ✅ Give up on a reserved record; its space is reclaimed on the next reset
+void WebhookSpool::discard(uint64_t seq) {
+    auto it = receiving.find(seq);
+    if (it == receiving.end()) {
+        return;
+    }
+
+    uint32_t kind = KIND_DISCARDED;
+    write_all(fd, reinterpret_cast<const char*>(&kind), sizeof(kind), it->second.location.offset - RECORD_HEADER_SIZE);
+    receiving.erase(it);
+    reset_if_idle();
+}
+
+bool WebhookSpool::locate(uint64_t seq, SpooledDelivery& out) const {
+    auto it = pending_records.find(seq);
+    if (it == pending_records.end()) {
+        return false;
+    }
+
+    char fixed[DELIVERY_FIXED_SIZE];
+    uint16_t lengths[2];
+    if (!read_at(fd, fixed, sizeof(fixed), it->second.offset)) {
+        spdlog::error("❌ Failed to read delivery {} from webhook spool {}", seq, path);
+        return false;
+    }
+    std::memcpy(lengths, fixed + sizeof(uint64_t), sizeof(lengths));
+    size_t prefix = DELIVERY_FIXED_SIZE + lengths[0] + lengths[1];
+    if (prefix > it->second.size) {
+        return false;
+    }
+
+    std::string strings(lengths[0] + lengths[1], '\0');
+    if (!read_at(fd, &strings[0], strings.size(), it->second.offset + DELIVERY_FIXED_SIZE)) {
+        return false;
+    }
+
+    out.seq = seq;
+    out.event = strings.substr(0, lengths[0]);
+    out.delivery_id = strings.substr(lengths[0]);
+    out.payload_offset = it->second.offset + prefix;
+    out.payload_size = it->second.size - prefix;
+    return true;
+}
+
+int WebhookSpool::reader() const {
+    return fd < 0 ? -1 : ::dup(fd);
+}
+
+// ✅ Mark a delivery processed; reset the file once nothing is pending
+void WebhookSpool::complete(uint64_t seq) {
+    if (pending_records.erase(seq) == 0) {
+        return;
+    }
+
+    std::string body(reinterpret_cast<const char*>(&seq), sizeof(seq));
+    append_record(KIND_DONE, body);
+    reset_if_idle();
+}
+
+void WebhookSpool::reset_if_idle() {
+    if (pending_records.empty() && receiving.empty() && file_size > TRUNCATE_MIN_BYTES) {
+        rewrite_pending();
+    }
+}
+
+std::vector<uint64_t> WebhookSpool::pending() const {
+    std::vector<uint64_t> seqs;
+    seqs.reserve(pending_records.size());
+    for (const auto& entry : pending_records) {
+        seqs.push_back(entry.first);
+    }
+    return seqs;
+}